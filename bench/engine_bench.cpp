@@ -0,0 +1,348 @@
+#include <benchmark/benchmark.h>
+#include "battle_royale.hpp"
+#include "beam_bot.hpp"
+#include "rewind_buffer.hpp"
+
+namespace
+{
+    constexpr uint64_t CORPUS_GAMES{32};
+    constexpr uint64_t CORPUS_PIECES_PER_GAME{48};
+    constexpr uint64_t CORPUS_WARMUP_PIECES{16};
+
+    struct CorpusBoard
+    {
+        GameManager gameManager;
+        Tetromino current;
+    };
+
+    struct Corpus
+    {
+        std::vector<CorpusBoard> boards;
+        // Pieces in the air above each board, every rotation at every legal column
+        std::vector<std::pair<size_t, Tetromino>> airborne;
+        std::vector<std::pair<size_t, Tetromino>> airborneI;
+        // Lock positions produced by the move generator on each board
+        std::vector<std::pair<size_t, Tetromino>> landings;
+    };
+
+    // Prefers the lowest landing and, among those, the one that leaves the fewest covered holes
+    int placementScore(const GameManager &gameManager, const Placement &placement)
+    {
+        GameManager after{gameManager};
+        after.handleCollision(placement.tetromino);
+        int holes{};
+        for (int j = 0; j < GRID_WIDTH; j++)
+        {
+            for (int i = GRID_HEIGHT - after.board.columnHeights[j]; i < GRID_HEIGHT; i++)
+            {
+                if (!(after.board.row(i) & (1u << j)))
+                    holes++;
+            }
+        }
+        return placement.tetromino.pos.y * 4 - holes * 8;
+    }
+
+    // Mid-game boards from seeded self-play, so every run measures the same positions
+    Corpus buildCorpus()
+    {
+        Corpus corpus;
+        MoveGenerator generator;
+        std::vector<Placement> placements;
+        std::vector<Action> path;
+
+        for (uint64_t game = 0; game < CORPUS_GAMES; game++)
+        {
+            Simulation simulation{game};
+            for (uint64_t piece = 0; piece < CORPUS_PIECES_PER_GAME; piece++)
+            {
+                generator.generate(simulation, placements);
+                if (piece >= CORPUS_WARMUP_PIECES)
+                    corpus.boards.push_back({simulation.getGameManager(), simulation.getCurrentTetromino()});
+
+                const Placement *best{&placements[0]};
+                for (const Placement &placement : placements)
+                {
+                    if (!placement.usedHold && placementScore(simulation.getGameManager(), placement) > placementScore(simulation.getGameManager(), *best))
+                        best = &placement;
+                }
+                generator.path(*best, path);
+                uint8_t events{};
+                for (Action action : path)
+                    events |= simulation.apply(action);
+                if (events & EVENT_TOPPED_OUT)
+                    break;
+            }
+        }
+
+        for (size_t index = 0; index < corpus.boards.size(); index++)
+        {
+            const GameManager &gameManager{corpus.boards[index].gameManager};
+            for (uint8_t type = 1; type < PIECE_TYPE_COUNT; type++)
+            {
+                std::optional<Tetromino> spawn{gameManager.newTetromino(Tetromino{static_cast<PieceType>(type)})};
+                if (!spawn)
+                    continue;
+                for (int8_t rotation = 0; rotation < 4; rotation++)
+                {
+                    for (int8_t x = -2; x < GRID_WIDTH; x++)
+                    {
+                        Tetromino tetromino{*spawn};
+                        tetromino.rotationIndex = rotation;
+                        tetromino.pos.x = x;
+                        if (!gameManager.isValidPosition(tetromino))
+                            continue;
+                        corpus.airborne.emplace_back(index, tetromino);
+                        if (tetromino.type == PieceType::I)
+                            corpus.airborneI.emplace_back(index, tetromino);
+                    }
+                }
+                generator.generate(gameManager, *spawn, *spawn, placements);
+                for (const Placement &placement : placements)
+                    corpus.landings.emplace_back(index, placement.tetromino);
+            }
+        }
+        return corpus;
+    }
+
+    const Corpus &corpus()
+    {
+        static const Corpus instance{buildCorpus()};
+        return instance;
+    }
+
+    template <typename Samples, typename Body>
+    void runOverSamples(benchmark::State &state, const Samples &samples, Body body)
+    {
+        size_t i{};
+        for (auto _ : state)
+        {
+            const auto &sample{samples[i]};
+            body(corpus().boards[sample.first].gameManager, sample.second);
+            if (++i == samples.size())
+                i = 0;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void BM_IsValidPosition(benchmark::State &state)
+{
+    runOverSamples(state, corpus().landings, [](const GameManager &gameManager, const Tetromino &tetromino)
+                   {
+                       benchmark::DoNotOptimize(gameManager.isValidPosition(tetromino, 0, 1));
+                       benchmark::DoNotOptimize(gameManager.isValidPosition(tetromino, 1, 0)); });
+}
+BENCHMARK(BM_IsValidPosition);
+
+static void BM_TryRotate(benchmark::State &state)
+{
+    runOverSamples(state, corpus().airborne, [](const GameManager &gameManager, const Tetromino &tetromino)
+                   {
+                       Tetromino rotated{tetromino};
+                       benchmark::DoNotOptimize(gameManager.tryRotate(rotated, tetromino.rotatedCW()));
+                       benchmark::DoNotOptimize(rotated); });
+}
+BENCHMARK(BM_TryRotate);
+
+static void BM_TryRotateI(benchmark::State &state)
+{
+    runOverSamples(state, corpus().airborneI, [](const GameManager &gameManager, const Tetromino &tetromino)
+                   {
+                       Tetromino rotated{tetromino};
+                       benchmark::DoNotOptimize(gameManager.tryRotate(rotated, tetromino.rotatedCW()));
+                       benchmark::DoNotOptimize(rotated); });
+}
+BENCHMARK(BM_TryRotateI);
+
+static void BM_RotatedCW(benchmark::State &state)
+{
+    runOverSamples(state, corpus().airborne, [](const GameManager &, const Tetromino &tetromino)
+                   { benchmark::DoNotOptimize(tetromino.rotatedCW()); });
+}
+BENCHMARK(BM_RotatedCW);
+
+static void BM_RotatedCCW(benchmark::State &state)
+{
+    runOverSamples(state, corpus().airborne, [](const GameManager &, const Tetromino &tetromino)
+                   { benchmark::DoNotOptimize(tetromino.rotatedCCW()); });
+}
+BENCHMARK(BM_RotatedCCW);
+
+static void BM_GhostDrop(benchmark::State &state)
+{
+    runOverSamples(state, corpus().airborne, [](const GameManager &gameManager, const Tetromino &tetromino)
+                   { benchmark::DoNotOptimize(gameManager.dropDistance(tetromino)); });
+}
+BENCHMARK(BM_GhostDrop);
+
+// Includes copying the GameManager, since the call mutates it
+static void BM_HandleCollision(benchmark::State &state)
+{
+    runOverSamples(state, corpus().landings, [](const GameManager &gameManager, const Tetromino &tetromino)
+                   {
+                       GameManager copy{gameManager};
+                       copy.handleCollision(tetromino);
+                       benchmark::DoNotOptimize(copy.board); });
+}
+BENCHMARK(BM_HandleCollision);
+
+// Range is the number of full rows at the bottom of each corpus board; includes the copy as above
+static void BM_ClearRows(benchmark::State &state)
+{
+    const int64_t fullRows{state.range(0)};
+    std::vector<GameManager> boards;
+    for (const CorpusBoard &corpusBoard : corpus().boards)
+    {
+        GameManager gameManager{corpusBoard.gameManager};
+        for (int64_t i = 0; i < fullRows; i++)
+        {
+            gameManager.board.rows[Board::TOTAL_HEIGHT - 1 - i] = Board::FULL_ROW;
+            gameManager.board.colors[Board::TOTAL_HEIGHT - 1 - i].fill(CYAN);
+        }
+        boards.push_back(gameManager);
+    }
+
+    size_t i{};
+    for (auto _ : state)
+    {
+        GameManager copy{boards[i]};
+        copy.clearRows();
+        benchmark::DoNotOptimize(copy.board);
+        if (++i == boards.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ClearRows)->DenseRange(0, 4);
+
+static void BM_GenerateBag(benchmark::State &state)
+{
+    GameManager gameManager{1};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(gameManager.generateBag());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GenerateBag);
+
+static void BM_SnapshotRestore(benchmark::State &state)
+{
+    Simulation simulation{1};
+    RewindBuffer rewindBuffer{static_cast<size_t>(REWIND_SECONDS * TICK_RATE)};
+    GameState snapshot{simulation.snapshot()};
+    for (auto _ : state)
+    {
+        rewindBuffer.push(simulation.snapshot());
+        rewindBuffer.pop(snapshot);
+        simulation.restore(snapshot);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(GameState));
+}
+BENCHMARK(BM_SnapshotRestore);
+
+static void BM_MoveGenerator(benchmark::State &state)
+{
+    MoveGenerator generator;
+    std::vector<Placement> placements;
+    size_t i{};
+    for (auto _ : state)
+    {
+        const CorpusBoard &board{corpus().boards[i]};
+        generator.generate(board.gameManager, board.current, board.current, placements);
+        benchmark::DoNotOptimize(placements.data());
+        if (++i == corpus().boards.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MoveGenerator);
+
+static void BM_MoveGeneratorDrops(benchmark::State &state)
+{
+    MoveGenerator generator;
+    std::vector<Placement> placements;
+    size_t i{};
+    for (auto _ : state)
+    {
+        const CorpusBoard &board{corpus().boards[i]};
+        generator.generateDrops(board.gameManager, board.current, board.current, placements);
+        benchmark::DoNotOptimize(placements.data());
+        if (++i == corpus().boards.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MoveGeneratorDrops);
+
+// Range is the batch size; every landing of every corpus board is evaluated once per pass
+template <void (*Kernel)(const Board *, const uint8_t *, size_t, BotFeatures *)>
+static void BM_BoardFeatures(benchmark::State &state)
+{
+    std::vector<Board> boards;
+    for (const auto &[index, tetromino] : corpus().landings)
+    {
+        Board board{corpus().boards[index].gameManager.board};
+        board.place(tetromino.mask(), tetromino.pos.x, tetromino.pos.y, tetromino.color());
+        boards.push_back(board);
+    }
+    std::vector<uint8_t> linesCleared(boards.size());
+    for (size_t i = 0; i < boards.size(); i++)
+        linesCleared[i] = boards[i].clearFullRows();
+
+    const size_t batch{static_cast<size_t>(state.range(0))};
+    std::vector<BotFeatures> features(batch);
+    size_t first{};
+    for (auto _ : state)
+    {
+        if (first + batch > boards.size())
+            first = 0;
+        Kernel(&boards[first], &linesCleared[first], batch, features.data());
+        benchmark::DoNotOptimize(features.data());
+        first += batch;
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK_TEMPLATE(BM_BoardFeatures, boardFeaturesScalar)->Arg(1)->Arg(FEATURE_BATCH_SIZE)->Arg(64);
+BENCHMARK_TEMPLATE(BM_BoardFeatures, boardFeatures)->Arg(1)->Arg(FEATURE_BATCH_SIZE)->Arg(64);
+
+// One 60 Hz frame of a full royale: every bot advanced on the pool, then attacks settled
+static void BM_RoyaleFrame(benchmark::State &state)
+{
+    ThreadPool pool;
+    std::optional<BattleRoyale> royale;
+    royale.emplace(ROYALE_MAX_PLAYERS, 1, pool);
+    for (auto _ : state)
+    {
+        if (royale->getSurvivors() == 1)
+        {
+            state.PauseTiming();
+            royale.reset();
+            royale.emplace(ROYALE_MAX_PLAYERS, 1, pool);
+            state.ResumeTiming();
+        }
+        royale->start(TICK_RATE / 60);
+        royale->finish(0, false);
+    }
+    state.SetItemsProcessed(state.iterations() * (ROYALE_MAX_PLAYERS - 1));
+}
+BENCHMARK(BM_RoyaleFrame)->UseRealTime();
+
+// Range is the beam width; with no deadline in reach every move searches the whole queue at full width
+static void BM_BeamPlan(benchmark::State &state)
+{
+    BeamSettings settings;
+    settings.width = static_cast<uint16_t>(state.range(0));
+    settings.budget = std::chrono::hours(1);
+    BeamBot bot{settings};
+    Simulation simulation{1};
+    for (auto _ : state)
+    {
+        if (bot.playPiece(simulation) & EVENT_TOPPED_OUT)
+            simulation.reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BeamPlan)->Arg(4)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN();
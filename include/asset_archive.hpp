@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Asset archives are an index followed by the raw file bytes:
+//   "TPAK", version, varint entry count,
+//   entries: varint name length, name, varint offset, varint size
+// Offsets count from the start of the archive, so an entry can be used in
+// place from a memory mapping or from an array linked into the executable.
+constexpr std::array<uint8_t, 4> ARCHIVE_MAGIC{'T', 'P', 'A', 'K'};
+constexpr uint8_t ARCHIVE_VERSION{1};
+constexpr std::string_view ASSET_ARCHIVE_NAME{"assets.tpak"};
+
+struct AssetEntry
+{
+    std::string_view name;
+    const uint8_t *data{};
+    size_t size{};
+};
+
+// Read-only view of an archive; the bytes must outlive it and every entry taken from it
+class AssetArchive
+{
+public:
+    AssetArchive(const uint8_t *data, size_t size);
+
+    const AssetEntry &get(std::string_view name) const;
+    const std::vector<AssetEntry> &getEntries() const { return entries; }
+
+private:
+    std::vector<AssetEntry> entries;
+};
+
+#ifdef TETRIS_EMBED_ASSETS
+// Archive linked into the executable, generated by tetris-pack --embed
+extern const uint8_t EMBEDDED_ASSETS[];
+extern const size_t EMBEDDED_ASSETS_SIZE;
+#endif
+
+// Builds an archive from the files under each root, named by their path relative to it
+std::vector<uint8_t> packAssets(const std::vector<std::filesystem::path> &roots);
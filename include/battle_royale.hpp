@@ -0,0 +1,75 @@
+#pragma once
+#include "bot.hpp"
+#include "thread_pool.hpp"
+
+constexpr uint8_t ROYALE_MAX_PLAYERS{99};
+// Bots each play at their own pace somewhere in this range of pieces per second
+constexpr float ROYALE_MIN_BOT_PPS{0.6f};
+constexpr float ROYALE_MAX_BOT_PPS{2.0f};
+// Bots advanced by one pool task
+constexpr size_t ROYALE_BOTS_PER_TASK{8};
+// Every surge interval each survivor is sent one more line of garbage than the surge before, up to a
+// full lock's worth, so a match between bots that rarely clear more than one row still comes to an end
+constexpr uint32_t ROYALE_SURGE_TICKS{20 * TICK_RATE};
+
+// A battle royale between the caller's player 0 and up to 98 bots, all on the
+// same piece sequence. Every attack goes to a random surviving player, on top
+// of the garbage surges, and a player who tops out is eliminated. The bots are advanced on the thread pool
+// between start and finish; in the meantime the boards published by the last
+// finish stay readable, so rendering overlaps with the bots' simulation.
+class BattleRoyale
+{
+public:
+    BattleRoyale(uint8_t playerCount, uint64_t seed, ThreadPool &_pool);
+    ~BattleRoyale();
+
+    BattleRoyale(const BattleRoyale &) = delete;
+    BattleRoyale &operator=(const BattleRoyale &) = delete;
+
+    // Starts advancing every surviving bot by ticks on the pool and returns at once
+    void start(uint32_t ticks);
+    // Waits for the bots, then sends out every attack made since the last finish,
+    // the human's included, and publishes the boards
+    void finish(uint8_t humanAttack, bool humanToppedOut);
+
+    // Garbage sent to player 0 by the last finish, as (lines, hole column) pairs
+    const std::vector<std::pair<uint8_t, uint8_t>> &getHumanGarbage() const { return humanGarbage; }
+
+    uint8_t getPlayerCount() const { return static_cast<uint8_t>(bots.size() + 1); }
+    uint8_t getSurvivors() const { return survivors; }
+    // Finishing position of an eliminated player, 1 for the winner, 0 while still playing
+    uint8_t getPlacement(uint8_t player) const { return placements[player]; }
+
+    // Published copies of the bots' boards, one per bot, safe to read while the bots run
+    const std::vector<Board> &getBotBoards() const { return shownBoards; }
+    const std::vector<uint8_t> &getBotEliminated() const { return shownEliminated; }
+
+private:
+    struct RoyaleBot
+    {
+        Simulation simulation;
+        Bot bot;
+        uint16_t thinkTicks;
+        uint16_t thinkElapsed{};
+        bool toppedOut{false};
+        uint8_t attack{};
+    };
+
+    void advance(RoyaleBot &royaleBot, uint32_t ticks);
+    void eliminate(uint8_t player);
+    uint8_t pickTarget(uint8_t attacker);
+    void sendGarbage(uint8_t target, uint8_t lines);
+
+    ThreadPool &pool;
+    std::vector<RoyaleBot> bots;
+    std::vector<uint8_t> placements;
+    uint8_t survivors;
+    bool running{false};
+    Xoshiro256 rng;
+    uint64_t elapsedTicks{};
+    uint32_t surges{};
+
+    std::vector<std::pair<uint8_t, uint8_t>> humanGarbage;
+    std::vector<Board> shownBoards;
+    std::vector<uint8_t> shownEliminated;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include "bot.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+
+constexpr uint16_t BEAM_FIRST_WIDTH{4};
+constexpr uint16_t BEAM_DEFAULT_WIDTH{64};
+// The current piece and every queued one
+constexpr uint8_t BEAM_MAX_DEPTH{PIECE_QUEUE_LENGTH + 1};
+constexpr std::chrono::microseconds BEAM_DEFAULT_BUDGET{1000};
+constexpr size_t BEAM_TABLE_MEGABYTES{4};
+
+struct BeamSettings
+{
+    // Most positions kept from one ply to the next
+    uint16_t width{BEAM_DEFAULT_WIDTH};
+    // Pieces placed along a line, capped by the pieces known
+    uint8_t depth{BEAM_MAX_DEPTH};
+    // Wall-clock time a move may take, root expansion included
+    std::chrono::microseconds budget{BEAM_DEFAULT_BUDGET};
+};
+
+struct BeamPlan
+{
+    // Inputs from the current piece's position to its lock, ending with the hard drop; empty when nothing fits
+    std::vector<Action> actions;
+    // Widest beam that finished, and the plies it searched in full
+    uint16_t width{};
+    uint8_t depth{};
+    uint32_t expanded{};
+};
+
+// Anytime beam search over the current piece, the hold piece and the queue. Each
+// ply expands the best positions of the last into every placement of the next
+// piece, with and without hold, and keeps the width best by the greedy bot's
+// evaluation plus the lines cleared on the way there. Positions reached twice
+// in one ply are merged through a transposition table. A move starts with a
+// narrow beam and doubles it while the budget lasts; each expansion is timed,
+// and none starts that would overrun the budget. The move played is the first
+// of the best line of the widest beam that finished.
+class BeamBot
+{
+public:
+    // With a pool, each ply's expansions are split across its workers
+    explicit BeamBot(const BeamSettings &_settings = {}, const BotWeights &_weights = DEFAULT_BOT_WEIGHTS, ThreadPool *_pool = nullptr);
+
+    BeamPlan plan(const Simulation &simulation);
+    // Plays one piece from its current position to lock and returns the combined simulation events
+    uint8_t playPiece(Simulation &simulation);
+
+    const BeamSettings &getSettings() const { return settings; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Node
+    {
+        GameManager gameManager;
+        // Weighted lines cleared along the line so far
+        float reward;
+        // Queue index of the piece this position places next
+        uint8_t queueIndex;
+        uint16_t root;
+    };
+
+    // A placement of one beam node, made into a node only if it is kept
+    struct Candidate
+    {
+        float score;
+        float reward;
+        uint16_t parent;
+        uint16_t root;
+        Tetromino piece;
+        // Hold piece after the placement
+        PieceType held;
+        uint8_t queueIndex;
+    };
+
+    // Everything one thread touches during a ply
+    struct Worker
+    {
+        MoveGenerator generator;
+        std::vector<Placement> placements;
+        std::vector<Board> boards;
+        std::vector<uint8_t> linesCleared;
+        std::vector<BotFeatures> features;
+        std::vector<Candidate> candidates;
+        Clock::duration slowestExpansion{};
+        uint32_t expanded{};
+        bool stopped{false};
+    };
+
+    // Best root placement of one beam, or nullopt when the budget ran out and acceptPartial is false.
+    // filled is set when some ply had more candidates than the beam could keep.
+    std::optional<uint16_t> search(const Node &root, uint16_t width, Clock::time_point deadline, bool acceptPartial, bool &filled, BeamPlan &result);
+    void expandRange(Worker &worker, size_t first, size_t stride, Clock::time_point deadline);
+    // Adds the placements of current to the worker's candidates. holdIndex is the queued piece a hold
+    // with nothing held brings in; a root expansion numbers each candidate's root after its placement.
+    void expand(Worker &worker, MoveGenerator &generator, const GameManager &gameManager, const Tetromino &current, uint8_t holdIndex, uint16_t parent,
+                float reward, std::optional<uint16_t> root);
+    void keepBest(uint16_t width);
+
+    BeamSettings settings;
+    BotWeights weights;
+    ThreadPool *pool;
+    TranspositionTable table{BEAM_TABLE_MEGABYTES};
+    uint64_t searches{};
+    // First Zobrist key of the run the expansions in progress are merged under
+    uint64_t searchKeys{};
+    // Time the last full ply of this move took to pick its beam, per position kept
+    Clock::duration selectionPerNode{};
+
+    // Kept apart so the first move's path survives the deeper plies
+    MoveGenerator rootGenerator;
+    std::vector<Placement> rootPlacements;
+    std::vector<Candidate> rootCandidates;
+    std::vector<PieceType> queue;
+    std::vector<Node> beam;
+    std::vector<Node> nextBeam;
+    std::vector<Candidate> merged;
+    std::vector<Worker> workers;
+};
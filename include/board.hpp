@@ -0,0 +1,188 @@
+#pragma once
+#include "zobrist.hpp"
+#include <algorithm>
+#include <type_traits>
+
+// Row masks of a piece inside its bounding box, bit j of row i is column j
+using PieceMask = std::array<uint16_t, 4>;
+
+// Narrowest row mask holding W cells
+template <uint8_t W>
+using BoardRow = std::conditional_t<(W <= 16), uint16_t, std::conditional_t<(W <= 32), uint32_t, uint64_t>>;
+
+// Occupancy bitboard with a parallel color plane used only for rendering.
+// Rows 0 to H - 1 are the visible field; the Buffer rows above it are hidden,
+// addressed with negative y, and keep the cells of pieces that rotate or lock
+// above the field. Everything above the buffer is solid.
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+struct BasicBoard
+{
+    static_assert(W >= 4 && W <= 56 && H + Buffer <= UINT8_MAX, "Board size out of range");
+
+    using Row = BoardRow<W>;
+    static constexpr uint8_t WIDTH{W};
+    static constexpr uint8_t HEIGHT{H};
+    static constexpr uint8_t BUFFER{Buffer};
+    static constexpr int TOTAL_HEIGHT{H + Buffer};
+    static constexpr Row FULL_ROW{static_cast<Row>(static_cast<Row>(~Row{}) >> (sizeof(Row) * 8 - W))};
+
+    // Stored from the top of the buffer: index y + Buffer holds row y
+    std::array<Row, TOTAL_HEIGHT> rows{};
+    std::array<std::array<Color, W>, TOTAL_HEIGHT> colors{};
+    // Filled height of each column measured from the floor, 0 for an empty column
+    std::array<uint8_t, W> columnHeights{};
+    // Zobrist hash of the filled cells, updated by every member that changes them
+    uint64_t hash{};
+
+    Row row(int y) const { return rows[y + Buffer]; }
+    const std::array<Color, W> &colorRow(int y) const { return colors[y + Buffer]; }
+    // Stored index of the highest row holding a cell, TOTAL_HEIGHT for an empty board; every row above it is empty
+    int stackTop() const { return TOTAL_HEIGHT - *std::max_element(columnHeights.begin(), columnHeights.end()); }
+
+    bool collides(const PieceMask &mask, int x, int y) const;
+    void place(const PieceMask &mask, int x, int y, Color color);
+    uint8_t clearFullRows();
+    // Pushes every row up and fills the bottom one except for holeColumn; true when cells were pushed off the top of the buffer
+    bool addGarbageRow(uint8_t holeColumn);
+    void clear();
+
+private:
+    // Rows are widened with solid walls around the playfield, so a single
+    // AND per piece row covers both the wall and the occupancy checks
+    using WideRow = std::conditional_t<(W + 8 <= 32), uint32_t, uint64_t>;
+    static constexpr int WALL_PADDING{4};
+    static constexpr WideRow WALLS{static_cast<WideRow>(~(WideRow{FULL_ROW} << WALL_PADDING))};
+
+    static uint64_t rowHash(int index, Row cells) { return ZOBRIST_ROWS<W, TOTAL_HEIGHT>.hash(index, cells); }
+    void recomputeColumnHeights(int firstRow);
+};
+
+// The board every game mode plays on
+using Board = BasicBoard<GRID_WIDTH, GRID_HEIGHT, GRID_BUFFER>;
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+bool BasicBoard<W, H, Buffer>::collides(const PieceMask &mask, int x, int y) const
+{
+    const int shift{x + WALL_PADDING};
+    if (shift < 0 || shift > static_cast<int>(sizeof(WideRow) * 8) - static_cast<int>(mask.size()))
+        return true;
+
+    for (int i = 0; i < static_cast<int>(mask.size()); i++)
+    {
+        if (mask[i] == 0)
+            continue;
+        const int row{y + i};
+        if (row >= H || row < -Buffer)
+            return true;
+        const WideRow occupied{static_cast<WideRow>(WALLS | WideRow{rows[row + Buffer]} << WALL_PADDING)};
+        if ((WideRow{mask[i]} << shift) & occupied)
+            return true;
+    }
+    return false;
+}
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+void BasicBoard<W, H, Buffer>::place(const PieceMask &mask, int x, int y, Color color)
+{
+    for (int i = 0; i < static_cast<int>(mask.size()); i++)
+    {
+        const int row{y + i};
+        if (mask[i] == 0 || row < -Buffer || row >= H)
+            continue;
+
+        const Row bits{static_cast<Row>((x >= 0 ? Row{mask[i]} << x : Row{mask[i]} >> -x) & FULL_ROW)};
+        rows[row + Buffer] |= bits;
+        hash ^= rowHash(row + Buffer, bits);
+        const uint8_t height{static_cast<uint8_t>(H - row)};
+        for (int j = 0; j < W; j++)
+        {
+            if (bits & (Row{1} << j))
+            {
+                colors[row + Buffer][j] = color;
+                columnHeights[j] = std::max(columnHeights[j], height);
+            }
+        }
+    }
+}
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+uint8_t BasicBoard<W, H, Buffer>::clearFullRows()
+{
+    // Rows above the stack are empty before and after, so the mostly empty buffer is never walked
+    const int top{stackTop()};
+    int writeRow{TOTAL_HEIGHT - 1};
+    uint8_t rowsCleared{};
+    for (int i = TOTAL_HEIGHT - 1; i >= top; i--)
+    {
+        if (rows[i] == FULL_ROW)
+        {
+            hash ^= rowHash(i, FULL_ROW);
+            rowsCleared++;
+            continue;
+        }
+        if (i != writeRow)
+        {
+            hash ^= rowHash(i, rows[i]) ^ rowHash(writeRow, rows[i]);
+            rows[writeRow] = rows[i];
+            colors[writeRow] = colors[i];
+        }
+        writeRow--;
+    }
+    for (int i = writeRow; i >= top; i--)
+    {
+        rows[i] = 0;
+        colors[i].fill(EMPTY);
+    }
+    if (rowsCleared > 0)
+        recomputeColumnHeights(top);
+    return rowsCleared;
+}
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+bool BasicBoard<W, H, Buffer>::addGarbageRow(uint8_t holeColumn)
+{
+    const bool overflowed{rows[0] != 0};
+    const int top{std::max(stackTop() - 1, 0)};
+    hash ^= rowHash(top, rows[top]);
+    for (int i = top; i < TOTAL_HEIGHT - 1; i++)
+    {
+        hash ^= rowHash(i + 1, rows[i + 1]) ^ rowHash(i, rows[i + 1]);
+        rows[i] = rows[i + 1];
+        colors[i] = colors[i + 1];
+    }
+    rows[TOTAL_HEIGHT - 1] = static_cast<Row>(FULL_ROW & ~(Row{1} << holeColumn));
+    hash ^= rowHash(TOTAL_HEIGHT - 1, rows[TOTAL_HEIGHT - 1]);
+    colors[TOTAL_HEIGHT - 1].fill(GARBAGE);
+    colors[TOTAL_HEIGHT - 1][holeColumn] = EMPTY;
+    recomputeColumnHeights(top);
+    return overflowed;
+}
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+void BasicBoard<W, H, Buffer>::recomputeColumnHeights(int firstRow)
+{
+    columnHeights.fill(0);
+    Row remaining{FULL_ROW};
+    for (int i = firstRow; i < TOTAL_HEIGHT && remaining; i++)
+    {
+        const Row topCells{static_cast<Row>(rows[i] & remaining)};
+        if (!topCells)
+            continue;
+        remaining &= ~topCells;
+        for (int j = 0; j < W; j++)
+        {
+            if (topCells & (Row{1} << j))
+                columnHeights[j] = static_cast<uint8_t>(TOTAL_HEIGHT - i);
+        }
+    }
+}
+
+template <uint8_t W, uint8_t H, uint8_t Buffer>
+void BasicBoard<W, H, Buffer>::clear()
+{
+    rows.fill(0);
+    columnHeights.fill(0);
+    hash = 0;
+    for (auto &row : colors)
+        row.fill(EMPTY);
+}
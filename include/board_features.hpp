@@ -0,0 +1,36 @@
+#pragma once
+#include "board.hpp"
+
+enum BotFeature : uint8_t
+{
+    FEATURE_AGGREGATE_HEIGHT,
+    FEATURE_HOLES,
+    FEATURE_BUMPINESS,
+    FEATURE_LINES_CLEARED,
+    FEATURE_ROW_TRANSITIONS,
+    FEATURE_WELL_DEPTH
+};
+constexpr uint8_t BOT_FEATURE_COUNT{6};
+
+using BotFeatures = std::array<float, BOT_FEATURE_COUNT>;
+
+// Boards evaluated per pass of the vector kernel, one board per 16-bit lane
+constexpr size_t FEATURE_BATCH_SIZE{16};
+
+// First stored row the row features look at: the top of the visible field, or of the stack once it reaches into the buffer
+inline int firstFeatureRow(const Board &board)
+{
+    return std::min<int>(Board::BUFFER, board.stackTop());
+}
+
+// Features of the board left behind by a placement, after its full rows were cleared
+BotFeatures boardFeatures(const Board &board, uint8_t linesCleared);
+
+// Features of count boards at once. Runs the AVX2 kernel when the CPU supports
+// it and otherwise evaluates the boards one at a time.
+void boardFeatures(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features);
+void boardFeaturesScalar(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features);
+#ifdef TETRIS_HAS_AVX2_KERNEL
+void boardFeaturesAvx2(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features);
+#endif
+bool boardFeaturesUseAvx2();
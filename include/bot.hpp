@@ -0,0 +1,34 @@
+#pragma once
+#include "board_features.hpp"
+#include "move_generator.hpp"
+
+using BotWeights = std::array<float, BOT_FEATURE_COUNT>;
+
+// A known-good starting point from the first four features alone, indexed by BotFeature
+constexpr BotWeights DEFAULT_BOT_WEIGHTS{{-0.510066f, -0.35663f, -0.184483f, 0.760666f, 0.0f, 0.0f}};
+
+// Greedy placement bot: plays the lock position whose resulting board has the
+// highest weighted feature sum, considering the hold piece as well
+class Bot
+{
+public:
+    explicit Bot(const BotWeights &_weights = DEFAULT_BOT_WEIGHTS) : weights(_weights) {}
+
+    std::optional<Placement> choose(const Simulation &simulation);
+    // Inputs from the current piece's position to the chosen lock, ending with the hard drop; empty when nothing fits
+    void plan(const Simulation &simulation, std::vector<Action> &actions);
+    // Plays one piece from spawn to lock and returns the combined simulation events
+    uint8_t playPiece(Simulation &simulation);
+
+    const BotWeights &getWeights() const { return weights; }
+
+private:
+    BotWeights weights;
+    MoveGenerator generator;
+    std::vector<Placement> placements;
+    // Board after each placement, evaluated together in one batch
+    std::vector<Board> candidates;
+    std::vector<uint8_t> linesCleared;
+    std::vector<BotFeatures> features;
+    std::vector<Action> path;
+};
@@ -1,8 +1,11 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <string_view>
+#include <vector>
 
-enum Color
+enum Color : uint8_t
 {
     EMPTY,
     CYAN,
@@ -13,7 +16,8 @@ enum Color
     PURPLE,
     RED,
     DARK_PURPLE,
-    TRANSPARENT
+    TRANSPARENT,
+    GARBAGE
 };
 
 struct Position
@@ -40,21 +44,40 @@ const std::array<std::vector<Position>, 4> kickTableICCW{{{{{0, 0}, {-1, 0}, {2,
 
 constexpr uint8_t GRID_WIDTH{10};
 constexpr uint8_t GRID_HEIGHT{20};
+// Hidden rows above the visible field, as in the guideline rules
+constexpr uint8_t GRID_BUFFER{20};
 
 constexpr uint16_t DEFAULT_WINDOW_WIDTH{1344};
 constexpr uint16_t DEFAULT_WINDOW_HEIGHT{756};
 constexpr uint16_t TARGET_WIDTH{1920};
 constexpr uint16_t TARGET_HEIGHT{1080};
-constexpr uint8_t FRAME_RATE{60};
+// 0 leaves rendering uncapped; gameplay always advances at TICK_RATE
+constexpr uint16_t FRAME_RATE{0};
+constexpr bool VERTICAL_SYNC{true};
 constexpr std::string_view WINDOW_TITLE{"Tetris"};
 
+constexpr uint16_t TICK_RATE{240};
+// Longest frame the simulation catches up on, so a stall cannot queue unbounded ticks
+constexpr float MAX_FRAME_TIME{0.25f};
 constexpr float DELAY{1.0f};
 constexpr float LOCK_DELAY{0.5f};
 constexpr uint8_t LOCK_LIMIT{10};
+// Held movement waits DAS_DELAY seconds, then repeats every ARR_DELAY seconds
+constexpr float DAS_DELAY{0.167f};
+constexpr float ARR_DELAY{0.033f};
+constexpr uint8_t SOFT_DROP_FACTOR{20};
+// Garbage lines sent for clearing 0 to 4 rows at once, and the most a single lock lets in
+constexpr std::array<uint8_t, 5> GARBAGE_ATTACK{0, 0, 1, 2, 4};
+constexpr uint8_t GARBAGE_PER_LOCK{8};
+// Practice mode keeps this many seconds of ticks to rewind through
+constexpr float REWIND_SECONDS{10.0f};
+// Pieces shown in the next queue, and the most it can be set to
+constexpr uint8_t DEFAULT_PREVIEW_COUNT{5};
+constexpr uint8_t PREVIEW_MAX{6};
+// Autoplay plays at most one piece per this many seconds, so it can be watched
+constexpr float AUTOPLAY_PIECE_DELAY{0.1f};
 
 constexpr float COLOR_SIZE{40.0f};
 constexpr float SPACING{0.0f};
 constexpr float CELL_SIZE{COLOR_SIZE + SPACING};
-constexpr float RECTANGLE_OUTLINE_SIZE{-1.5f};
-
-sf::Color enumToColor(Color choice);
\ No newline at end of file
+constexpr float RECTANGLE_OUTLINE_SIZE{-1.5f};
\ No newline at end of file
@@ -1,14 +1,44 @@
 #pragma once
 
+#include <SFML/Audio.hpp>
+#include <deque>
+#include <functional>
+#include <future>
+#include <random>
 #include "common.hpp"
 #include "tetromino.hpp"
 #include "render.hpp"
-#include "game_manager.hpp"
+#include "simulation.hpp"
+#include "input.hpp"
+#include "replay.hpp"
+#include "rewind_buffer.hpp"
+#include "mapped_file.hpp"
+#include "asset_archive.hpp"
+#include "sound_pool.hpp"
+#include "netplay.hpp"
+#include "battle_royale.hpp"
+#include "beam_bot.hpp"
+#include "trace.hpp"
+
+struct GameOptions
+{
+    // Plays this replay back in real time instead of a live game
+    std::string replayPath;
+    std::filesystem::path assetPath{ASSET_ARCHIVE_NAME};
+    // Plays a versus match against another instance instead of a single game
+    std::optional<NetplayOptions> netplay;
+    // Plays a battle royale against bots with this many players in all, the local one included
+    uint8_t royalePlayers{};
+    // Starts with the beam bot playing the local game
+    bool autoplay{false};
+    // Queued pieces shown from NEXT down, 1 to PREVIEW_MAX
+    uint8_t previewCount{DEFAULT_PREVIEW_COUNT};
+};
 
 class Game
 {
 public:
-    Game();
+    explicit Game(const GameOptions &options = {});
     void run();
 
 private:
@@ -20,34 +50,113 @@ private:
     bool isFullscreen{false};
     const sf::VideoMode fullscreenMode = sf::VideoMode::getDesktopMode();
 
+    // Each asset loads on its own worker thread; install runs on the main thread once it is done
+    struct PendingAsset
+    {
+        std::future<void> loading;
+        std::function<void()> install;
+        bool required;
+    };
+
+    // Assets are read in place from the archive, so it has to outlive everything loaded from it
+    std::optional<MappedFile> assetFile;
+    std::optional<AssetArchive> assets;
+
     sf::Image icon;
+    bool iconLoaded{false};
     sf::Font roboto;
     sf::Music themeMusic;
-    sf::SoundBuffer rotate;
-    sf::Sound rotateSound;
-    sf::SoundBuffer hardDrop;
-    sf::Sound hardDropSound;
-    sf::SoundBuffer hold;
-    sf::Sound holdSound;
-    sf::SoundBuffer invalid;
-    sf::Sound invalidSound;
+    bool musicLoaded{false};
+    SoundPool sounds;
+    std::vector<PendingAsset> pendingAssets;
+    size_t assetCount{};
 
-    Tetromino currentTetromino;
-    std::vector<Tetromino> bag;
+    Render renderer{window, roboto};
+    Simulation simulation{std::random_device{}()};
+    ReplayWriter replayWriter{simulation.getGameManager().getRandomizer().getSeed(), simulation.getGameManager().getRandomizer().getMode()};
 
-    bool grounded{false};
-    bool wasGrounded{grounded};
+    // In versus play the shown board is the local player's in the rollback session, and
+    // held buttons go to the session as a mask instead of through inputHandler
+    std::optional<Netplay> netplay;
+    uint8_t heldButtons{};
 
-    sf::Clock delayClock;
-    sf::Clock lockDelayClock;
-    sf::Time lockDelayElapsed;
+    // In a battle royale the bots run on the pool while a frame renders. The local
+    // player's attacks and top-out are gathered over the frame's ticks and settled
+    // with the bots' at the start of the next frame.
+    uint8_t royalePlayers{};
+    std::optional<ThreadPool> royalePool;
+    std::optional<BattleRoyale> royale;
+    uint8_t royaleAttack{};
+    bool royaleToppedOut{false};
+    bool royaleRestart{false};
 
-    uint8_t lockCounter{};
+    // Autoplay hands the local game to the beam bot. Each piece is searched on a
+    // worker thread while frames go on; the plan is played before a later tick if
+    // the piece has not moved since the search saw it, and searched again if it has.
+    bool autoplay{false};
+    BeamBot autoplayBot;
+    std::future<BeamPlan> autoplaySearch;
+    std::optional<BeamPlan> autoplayPlan;
+    Tetromino autoplayPiece;
+    uint64_t autoplayPosition{};
+    uint64_t autoplayNextTick{};
+    uint16_t autoplayWidth{};
+    uint8_t autoplayDepth{};
 
-    Render renderer{window, roboto};
-    GameManager gameManager{themeMusic, lockCounter};
+    std::optional<MappedFile> replayFile;
+    std::optional<ReplayReader> replayReader;
+    std::optional<ReplayEvent> pendingReplayEvent;
+
+    // Key transitions stamped with the start of the span they were pressed in, held back
+    // until a tick that ends after it
+    struct TimedInput
+    {
+        sf::Time time;
+        Action button;
+        bool pressed;
+    };
+    sf::Clock gameClock;
+    // End of the last frame's span; the keys polled this frame were pressed after it
+    sf::Time frameStart;
+    std::deque<TimedInput> pendingInputs;
+    InputHandler inputHandler;
+    std::vector<Action> inputActions;
+
+    FrameTimeStats frameTimes;
+    // Practice mode snapshots every tick so holding the rewind key steps back through them.
+    // Rewinding rewrites history, so a session that used it saves no replay.
+    bool practiceMode{false};
+    bool rewindHeld{false};
+    bool practiced{false};
+    RewindBuffer rewindBuffer{static_cast<size_t>(REWIND_SECONDS * TICK_RATE)};
+
+    bool showFrameStats{false};
+    float frameP50{};
+    float frameP99{};
 
     void applyView();
-    void loadAssets();
+    void loadAsync(bool required, std::function<void()> work, std::function<void()> install);
+    void startLoading();
+    void loadSound(SoundId id, const std::string &path, const std::string &name);
+    void pollAssets();
+    bool requiredAssetsReady() const;
     void handleInputs();
+    void queueInput(sf::Keyboard::Scancode scancode, bool pressed);
+    void deliverInputs(sf::Time until);
+    void stepSimulation();
+    void applyAction(Action action);
+    void advanceReplay();
+    void handleEvents(uint8_t events);
+    void dumpTrace();
+    void togglePracticeMode();
+    void toggleAutoplay();
+    void playAutoplay();
+    void searchAutoplay();
+    uint64_t autoplayHash() const;
+    const Simulation &shownSimulation() const;
+    void drawVersus();
+    void startRoyale();
+    void stepRoyale(uint32_t ticks);
+    void drawRoyale();
+    bool isRewinding() const { return practiceMode && rewindHeld; }
 };
\ No newline at end of file
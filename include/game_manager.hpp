@@ -1,55 +1,119 @@
 #pragma once
-#include <SFML/Audio.hpp>
 #include <tetromino.hpp>
 #include <algorithm>
-#include <random>
+#include "randomizer.hpp"
+
+constexpr uint8_t BAG_SIZE{7};
+// Pieces waiting behind the current one between moves, a full bag's worth: the whole preview and more for the bots
+constexpr uint8_t PIECE_QUEUE_LENGTH{BAG_SIZE};
+// Ring size, a power of two so wrapping is a mask
+constexpr uint8_t PIECE_QUEUE_CAPACITY{8};
+static_assert(PIECE_QUEUE_LENGTH >= PREVIEW_MAX && PIECE_QUEUE_LENGTH <= PIECE_QUEUE_CAPACITY, "Queue must hold the preview");
+static_assert((PIECE_QUEUE_CAPACITY & (PIECE_QUEUE_CAPACITY - 1)) == 0, "Queue capacity must be a power of two");
+
+inline uint64_t zobristPiece(PieceType type)
+{
+    return zobristKey(ZOBRIST_PIECE_KEYS + static_cast<uint8_t>(type));
+}
+inline uint64_t zobristHold(PieceType type, bool canHold)
+{
+    return zobristKey(ZOBRIST_HOLD_KEYS + static_cast<uint8_t>(type) * 2u + canHold);
+}
+// Key of the piece at index in the queue, counted from the next piece
+inline uint64_t zobristQueue(uint8_t index, PieceType type)
+{
+    return zobristKey(ZOBRIST_QUEUE_KEYS + index * uint64_t{PIECE_TYPE_COUNT} + static_cast<uint8_t>(type));
+}
+
+// Upcoming pieces in a fixed ring, stored inline so the game state stays trivially
+// copyable. GameManager streams pieces in from the randomizer one at a time, so the
+// queue never waits for a bag boundary and every operation is a few index updates.
+class PieceQueue
+{
+public:
+    void push(const Tetromino &tetromino) { pieces[(first + count++) & MASK] = tetromino; }
+    void popFront()
+    {
+        first = (first + 1) & MASK;
+        count--;
+    }
+    void clear()
+    {
+        first = 0;
+        count = 0;
+    }
+
+    const Tetromino &operator[](uint8_t index) const { return pieces[(first + index) & MASK]; }
+    const Tetromino &front() const { return pieces[first]; }
+    uint8_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    static constexpr uint8_t MASK{PIECE_QUEUE_CAPACITY - 1};
+
+    std::array<Tetromino, PIECE_QUEUE_CAPACITY> pieces{};
+    uint8_t first{};
+    uint8_t count{};
+};
 
 class GameManager
 {
 public:
-    GameManager(sf::Music &_themeMusic, uint8_t &_lockCounter) : themeMusic(_themeMusic), lockCounter(_lockCounter) {};
-
-    void initializeTetrominoes();
-    std::vector<Tetromino> generateBag();
-    bool tryRotate(Tetromino &currentTetromino, const Tetromino &rotatedPiece);
-    std::optional<Tetromino> newTetromino(const Tetromino &tetromino);
-    bool isValidPosition(const Tetromino &tetromino, int8_t deltaX = 0, int8_t deltaY = 0);
-    bool isGrounded(const Tetromino &tetromino);
+    explicit GameManager(uint64_t seed = 0, RandomizerMode mode = RandomizerMode::BAG_7) : randomizer(seed, mode) {}
+
+    std::array<Tetromino, BAG_SIZE> generateBag();
+    // Tops the queue up to PIECE_QUEUE_LENGTH from the randomizer; every member that takes a piece off calls it
+    void fillQueue(PieceQueue &queue);
+    bool tryRotate(Tetromino &currentTetromino, const Tetromino &rotatedPiece) const;
+    std::optional<Tetromino> newTetromino(const Tetromino &tetromino) const;
+    bool isValidPosition(const Tetromino &tetromino, int8_t deltaX = 0, int8_t deltaY = 0) const;
+    bool isGrounded(const Tetromino &tetromino) const;
+    int8_t dropDistance(const Tetromino &tetromino) const;
     void handleCollision(const Tetromino &tetromino);
-    void handleWreck(Tetromino &tetromino, std::vector<Tetromino> &bag);
-    bool holdTetromino(Tetromino &tetromino, std::vector<Tetromino> &bag);
-    void clearRows();
+    bool handleWreck(Tetromino &tetromino, PieceQueue &queue, bool forceTopOut = false);
+    bool holdTetromino(Tetromino &tetromino, PieceQueue &queue);
+    uint8_t clearRows();
+    void reset(PieceQueue &queue);
+    // Zobrist hash of what decides the game from here: the board, the current piece,
+    // the hold state and the first previewCount queued pieces. The board part is kept
+    // up to date by handleCollision and clearRows; the rest is a few XORs.
+    uint64_t positionHash(const Tetromino &current, const PieceQueue &queue, uint8_t previewCount) const;
 
-    std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT> screenState{};
+    Board board{};
 
     int getScore() const { return score; }
     unsigned int getLevel() const { return level; }
+    // Bumped whenever score or level changes, so observers can skip redundant work
+    uint32_t getStatsRevision() const { return statsRevision; }
     Tetromino getHeldTetromino() const { return heldTetromino; }
+    bool getCanHold() const { return canHold; }
+    bool getHasHeld() const { return hasHeld; }
+    const Randomizer &getRandomizer() const { return randomizer; }
 
-    void setScore(int _score) { score = _score; }
-    void setLevel(unsigned int _level) { level = _level; }
+    void setScore(int _score)
+    {
+        score = _score;
+        statsRevision++;
+    }
+    void setLevel(unsigned int _level)
+    {
+        level = _level;
+        statsRevision++;
+    }
     void setCanHold(bool _canHold) { canHold = _canHold; }
     void setHasHeld(bool _hasHeld) { hasHeld = _hasHeld; }
     void setHeldTetromino(const Tetromino &_heldTetromino) { heldTetromino = _heldTetromino; }
 
 private:
-    std::vector<Tetromino> tetrominoes = {
-        {2, 'O', YELLOW},
-        {4, 'I', CYAN},
-        {3, 'S', GREEN},
-        {3, 'Z', RED},
-        {3, 'L', ORANGE},
-        {3, 'J', BLUE},
-        {3, 'T', PURPLE},
-    };
-
-    sf::Music &themeMusic;
+    Randomizer randomizer;
     Tetromino heldTetromino;
 
     bool canHold{true};
     bool hasHeld{false};
 
-    uint8_t lockCounter;
     uint16_t level{1};
     uint32_t score{};
-};
\ No newline at end of file
+    uint32_t statsRevision{};
+};
+
+static_assert(std::is_trivially_copyable_v<GameManager>, "GameManager state must be copyable with the game state");
@@ -0,0 +1,49 @@
+#pragma once
+#include "simulation.hpp"
+
+// Auto-shift timings in ticks. An ARR of 0 shifts all the way to the wall at once, when
+// DAS expires and again for each new piece while the key stays held, and a held soft
+// drop falls softDropFactor times faster than gravity.
+struct InputSettings
+{
+    uint16_t dasTicks{static_cast<uint16_t>(DAS_DELAY * TICK_RATE + 0.5f)};
+    uint16_t arrTicks{static_cast<uint16_t>(ARR_DELAY * TICK_RATE + 0.5f)};
+    uint8_t softDropFactor{SOFT_DROP_FACTOR};
+};
+
+// Turns key transitions into simulation actions at tick resolution, so held
+// movement repeats on the same ticks whatever the frame rate or OS key repeat.
+// Every button is identified by the action its press performs.
+class InputHandler
+{
+public:
+    explicit InputHandler(const InputSettings &_settings = {}) : settings(_settings) {}
+
+    // Both append the actions that happen at once, in the order they happen
+    void press(Action button, std::vector<Action> &actions);
+    void release(Action button);
+    void releaseAll();
+    // Presses and releases buttons so the held set matches a mask with bit n for Action n,
+    // the form inputs travel in over the network
+    void setHeld(uint8_t buttons, std::vector<Action> &actions);
+    // Advances the held buttons by one tick and appends the repeats that fall due
+    void tick(uint16_t gravityDelayTicks, std::vector<Action> &actions);
+    // Takes the simulation events of a tick, so a new piece is slid to the wall again
+    void handleEvents(uint8_t events);
+
+private:
+    bool isHeld(Action button) const { return held[static_cast<uint8_t>(button)]; }
+    void startShift(Action direction);
+
+    InputSettings settings;
+    std::array<bool, ACTION_COUNT> held{};
+
+    // Last pressed direction wins while both are held
+    std::optional<Action> shiftDirection;
+    uint16_t shiftElapsed{};
+    // An ARR of 0 slides once per charge and piece rather than on every tick
+    bool slideDue{false};
+    uint16_t softDropElapsed{};
+};
+
+static_assert(std::is_trivially_copyable_v<InputHandler>, "InputHandler state must be copyable with the versus state");
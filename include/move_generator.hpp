@@ -0,0 +1,57 @@
+#pragma once
+#include "simulation.hpp"
+#include "transposition_table.hpp"
+#include <bitset>
+
+// Search space covers every (x, y, rotation) a piece can occupy, with room above the board for kicks
+constexpr int MOVEGEN_X_OFFSET{3};
+constexpr int MOVEGEN_Y_OFFSET{4};
+constexpr int MOVEGEN_X_SPAN{GRID_WIDTH + MOVEGEN_X_OFFSET};
+constexpr int MOVEGEN_Y_SPAN{GRID_HEIGHT + MOVEGEN_Y_OFFSET};
+constexpr size_t MOVEGEN_NODE_COUNT{MOVEGEN_X_SPAN * MOVEGEN_Y_SPAN * 4};
+
+struct Placement
+{
+    Tetromino tetromino; // piece at its lock position
+    bool usedHold{false};
+    uint16_t node{}; // search node the piece is hard dropped from
+};
+
+// Enumerates every distinct lock position reachable from spawn through moves,
+// soft drops and SRS rotations (including kicks), assuming no gravity acts
+// between inputs. Placements that fill the same cells are reported once, with
+// the shortest input path found by the breadth-first search.
+class MoveGenerator
+{
+public:
+    void generate(const GameManager &gameManager, const Tetromino &current, const Tetromino &next, std::vector<Placement> &placements);
+    void generate(const Simulation &simulation, std::vector<Placement> &placements);
+    // The lock positions reached by rotating and shifting at spawn height and then hard dropping,
+    // a fraction of generate's cost for lookahead that can do without tucks and spins. These
+    // placements have no input path.
+    void generateDrops(const GameManager &gameManager, const Tetromino &current, const Tetromino &next, std::vector<Placement> &placements);
+    // Inputs from spawn to lock, ending with the hard drop
+    void path(const Placement &placement, std::vector<Action> &actions) const;
+
+    // Counts the placement sequences of the queued pieces to the given depth, without hold.
+    // With a table, the count below a board reached again through other placements is looked up.
+    uint64_t perft(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, TranspositionTable *table = nullptr);
+
+private:
+    struct SearchTree
+    {
+        std::bitset<MOVEGEN_NODE_COUNT> visited;
+        std::array<uint16_t, MOVEGEN_NODE_COUNT> parent;
+        std::array<Action, MOVEGEN_NODE_COUNT> via;
+        std::array<Tetromino, MOVEGEN_NODE_COUNT> queue;
+    };
+
+    void search(const GameManager &gameManager, const Tetromino &spawn, bool usedHold, std::vector<Placement> &placements);
+    void drops(const GameManager &gameManager, const Tetromino &spawn, bool usedHold, std::vector<Placement> &placements);
+    uint64_t perftLevel(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, uint8_t ply, TranspositionTable *table);
+    uint64_t perftCount(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, uint8_t ply, TranspositionTable *table);
+
+    std::array<SearchTree, 2> trees;
+    std::vector<uint64_t> seenKeys;
+    std::vector<std::vector<Placement>> perftPlacements;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include "rollback.hpp"
+#include "udp_socket.hpp"
+#include <chrono>
+#include <deque>
+#include <string>
+
+// Packets are "TNET", version, type, then little-endian fields:
+//   HELLO   (guest to host): the guest's input settings
+//   WELCOME (host to guest): match seed, the host's input settings
+//   INPUTS: sender tick, inputs confirmed from the receiver, send time, echoed time,
+//           checksum tick and checksum, first tick, count, one held mask per tick
+// INPUTS carries every local input the peer has not confirmed, so a lost packet
+// is covered by the next one without any retransmission logic.
+constexpr std::array<uint8_t, 4> NETPLAY_MAGIC{'T', 'N', 'E', 'T'};
+constexpr uint8_t NETPLAY_VERSION{2};
+constexpr uint16_t NETPLAY_DEFAULT_PORT{7000};
+// Hellos repeat until welcomed, and a peer silent for the timeout is gone
+constexpr uint32_t NETPLAY_HELLO_INTERVAL_MS{100};
+constexpr uint32_t NETPLAY_TIMEOUT_MS{5000};
+// Ticks ahead of the remote player tolerated before a tick is skipped, and the fewest ticks between skips
+constexpr int32_t TIME_SYNC_SLACK_TICKS{2};
+constexpr uint32_t TIME_SYNC_SPACING_TICKS{4};
+
+// Artificial delay and loss applied to outgoing packets, for testing on one machine
+struct NetworkConditions
+{
+    uint16_t latencyMs{};
+    uint16_t jitterMs{};
+    float lossPercent{};
+};
+
+struct NetplayOptions
+{
+    // A host listens on port; a guest binds port (0 for any) and connects to hostAddress
+    bool hosting{true};
+    uint16_t port{NETPLAY_DEFAULT_PORT};
+    std::string hostAddress;
+    uint64_t seed{};
+    InputSettings inputSettings;
+    NetworkConditions conditions;
+};
+
+// Applies one of --host PORT, --join HOST:PORT, --latency MS, --jitter MS or --loss PERCENT;
+// false when arg is not a netplay option
+bool parseNetplayOption(const std::string &arg, const std::string &value, NetplayOptions &options);
+
+// One side of a two-player versus match over UDP. Every call is non-blocking:
+// poll drains the socket, and advance runs a tick of the rollback session
+// whenever it may, so local input is never held back waiting for the network.
+class Netplay
+{
+public:
+    explicit Netplay(const NetplayOptions &options);
+
+    // Receives and handles every waiting packet, and sends any due handshake or delayed packets
+    void poll();
+    // Runs one tick with the local held buttons and sends the unconfirmed inputs.
+    // Returns the local player's events, or nothing while the match holds back for the remote player.
+    std::optional<uint8_t> advance(uint8_t localHeld);
+
+    bool isStarted() const { return session.has_value(); }
+    bool isDisconnected() const;
+    const RollbackSession &getSession() const { return *session; }
+    float getRoundTripMs() const { return roundTripMs; }
+    uint64_t getStalls() const { return stalls; }
+    // Tick of the first checksum mismatch with the peer, if the simulations ever diverged
+    std::optional<uint32_t> getDesyncTick() const { return desyncTick; }
+
+private:
+    enum PacketType : uint8_t
+    {
+        PACKET_HELLO,
+        PACKET_WELCOME,
+        PACKET_INPUTS
+    };
+
+    struct DelayedPacket
+    {
+        uint32_t releaseMs;
+        std::vector<uint8_t> bytes;
+    };
+
+    uint32_t nowMs() const;
+    std::vector<uint8_t> startPacket(PacketType type) const;
+    void send(std::vector<uint8_t> packet);
+    void flushDelayed();
+    void sendInputs();
+    void handlePacket(const uint8_t *data, size_t size, const UdpAddress &from);
+    void handleInputs(const uint8_t *data, size_t size);
+    bool shouldStall() const;
+
+    const NetplayOptions options;
+    const std::chrono::steady_clock::time_point origin;
+    UdpSocket socket;
+    std::optional<UdpAddress> peer;
+    std::optional<RollbackSession> session;
+
+    // Local inputs the peer has confirmed, counted from tick 0
+    uint32_t peerAck{};
+    uint32_t lastHelloMs{};
+    uint32_t lastReceiveMs{};
+
+    // Round trip is measured by the peer echoing our send time, less the time it held it
+    float roundTripMs{};
+    uint32_t peerSendMs{};
+    uint32_t peerSendReceivedMs{};
+    uint32_t peerTick{};
+    uint32_t peerTickReceivedMs{};
+    uint32_t ticksSinceStall{};
+    uint64_t stalls{};
+    std::optional<uint32_t> desyncTick;
+
+    Xoshiro256 conditionsRng;
+    std::deque<DelayedPacket> delayed;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "tetromino.hpp"
+
+// xoshiro256** (Blackman and Vigna), seeded through splitmix64
+class Xoshiro256
+{
+public:
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed);
+    uint64_t next();
+    uint32_t below(uint32_t bound);
+
+private:
+    std::array<uint64_t, 4> state{};
+};
+
+enum class RandomizerMode : uint8_t
+{
+    BAG_7,
+    BAG_14,
+    RANDOM,
+    HISTORY
+};
+
+// Piece generator for every supported strategy. The strategy is picked by mode
+// rather than by subclass so that the whole randomizer, generator state
+// included, stays trivially copyable and can be snapshotted with the game.
+class Randomizer
+{
+public:
+    explicit Randomizer(uint64_t seed = 0, RandomizerMode mode = RandomizerMode::BAG_7);
+
+    void reseed(uint64_t seed);
+    PieceType next();
+
+    RandomizerMode getMode() const { return mode; }
+    uint64_t getSeed() const { return seed; }
+
+private:
+    PieceType nextFromBag(uint8_t copies);
+    PieceType nextRandom();
+    PieceType nextFromHistory();
+
+    Xoshiro256 rng;
+    uint64_t seed;
+    RandomizerMode mode;
+
+    std::array<PieceType, 14> bag{};
+    uint8_t bagRemaining{};
+
+    std::array<PieceType, 4> history{};
+    bool firstPiece{true};
+};
+
+static_assert(std::is_trivially_copyable_v<Randomizer>, "Randomizer state must be copyable with the game state");
@@ -1,23 +1,94 @@
 #pragma once
-#include "tetromino.hpp"
+#include <SFML/Graphics.hpp>
+#include "game_manager.hpp"
+
+sf::Color enumToColor(Color choice);
+
+constexpr sf::Color BACKGROUND_COLOR{0, 0, 28};
+
+// Every cell is an outline quad with the fill quad inset on top, as two triangles each
+constexpr size_t CELL_VERTEX_COUNT{12};
+// A miniature board is one plain quad per cell and an elimination overlay quad
+constexpr size_t MINI_BOARD_VERTEX_COUNT{(GRID_WIDTH * GRID_HEIGHT + 1) * CELL_VERTEX_COUNT / 2};
 
 class Render
 {
 public:
-    Render(sf::RenderWindow &_window, sf::Font &_roboto) : window(_window), roboto(_roboto) {};
+    Render(sf::RenderWindow &_window, sf::Font &_roboto);
 
     void drawHeldTetromino(const Tetromino &tetromino);
-    void drawTetromino(const Tetromino &tetromino);
-    void drawNextTetromino(const Tetromino &tetromino);
-    void drawText(sf::Text &text, std::string content, float posX, float posY);
-    void drawGrid(std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT> screenState);
+    void drawTetromino(const Tetromino &tetromino, bool ghost = false, float offsetY = 0.0f);
+    // The first previewCount pieces of the queue, the next one full size and the rest smaller below it
+    void drawNextTetromino(const PieceQueue &queue);
+    // Sizes the preview frame, so it is set before the static layer is built
+    void setPreviewCount(uint8_t count) { previewCount = count; }
+    void buildStaticLayer();
+    void drawStaticLayer();
+    void drawStats(int score, unsigned int level, uint32_t revision);
+    void drawGrid(const Board &board);
+    void drawFrameStats(float p50, float p99);
+    void drawPracticeMode(bool rewinding);
+    // Width and depth of the beam behind the bot's last move
+    void drawAutoplay(uint16_t width, uint8_t depth);
+    // Versus play: the opponent's board at a reduced scale, incoming garbage, and match messages
+    void drawOpponent(const Board &board, uint8_t garbagePending);
+    void drawGarbageMeter(uint8_t lines);
+    void drawMessage(std::string_view text);
+    // Battle royale: every opponent's board in miniature, split between both sides of the playfield
+    void drawMiniBoards(const std::vector<Board> &boards, const std::vector<uint8_t> &eliminated);
+    void drawSurvivors(uint8_t survivors, uint8_t players);
+    // Needs no font, so it can be drawn before any asset has loaded
+    void drawLoadingScreen(float progress);
+    void drawPieces();
 
     float getStartX() const { return startX; }
     float getStartY() const { return startY; }
 
 private:
+    float holdBoxX() const { return startX + GRID_WIDTH * CELL_SIZE - CELL_SIZE * 19; }
+    float nextBoxX() const { return startX + GRID_WIDTH * CELL_SIZE + CELL_SIZE * 3; }
+    float previewBoxY() const { return startY + CELL_SIZE * 5; }
+    void drawPreviewBox(float previewBoxX, float previewBoxY, const Tetromino &tetromino);
+    void drawQueuedPiece(float slotX, float slotY, const Tetromino &tetromino);
+    void drawPreviewFrame(sf::RenderTarget &target, std::string_view title, float previewBoxX, float previewBoxY);
+    void appendCell(float posX, float posY, Color color, bool outlined, float size = COLOR_SIZE);
+    void layoutMiniBoards(size_t count);
+
     float startX, startY;
+    uint8_t previewCount{DEFAULT_PREVIEW_COUNT};
 
     sf::RenderWindow &window;
     sf::Font &roboto;
-};
\ No newline at end of file
+
+    // Background, grid and preview frames with their labels, rendered once
+    sf::RenderTexture staticLayer;
+    std::optional<sf::Sprite> staticSprite;
+
+    sf::Text textScore{roboto, "", 96};
+    sf::Text textLevel{roboto, "", 96};
+    std::optional<uint32_t> statsRevision;
+    sf::Text textFrameStats{roboto, "", 28};
+    std::optional<std::pair<float, float>> shownFrameStats;
+    std::optional<std::pair<uint16_t, uint8_t>> shownAutoplay;
+    sf::Text textPractice{roboto, "", 28};
+    sf::Text textAutoplay{roboto, "", 28};
+    sf::Text textMessage{roboto, "", 64};
+    sf::VertexArray opponentCells{sf::PrimitiveType::Triangles};
+    sf::Text textSurvivors{roboto, "", 48};
+    std::optional<std::pair<uint8_t, uint8_t>> shownSurvivors;
+
+    // All miniatures share one vertex buffer, drawn in a single call. Only the runs of
+    // boards whose cells changed since the last frame are uploaded again; without
+    // vertex buffer support the CPU copy is drawn directly.
+    sf::VertexBuffer miniBuffer{sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Stream};
+    bool miniBuffered{false};
+    std::vector<sf::Vertex> miniVertices;
+    std::vector<std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT>> miniColors;
+    std::vector<uint8_t> miniEliminated;
+
+    // Locked cells persist between frames and only changed cells are rewritten
+    sf::VertexArray boardCells{sf::PrimitiveType::Triangles, GRID_WIDTH * GRID_HEIGHT * CELL_VERTEX_COUNT};
+    std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT> drawnColors;
+    // Ghost, active, hold and next pieces, rebuilt each frame and drawn in one call
+    sf::VertexArray pieceCells{sf::PrimitiveType::Triangles};
+};
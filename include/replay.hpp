@@ -0,0 +1,66 @@
+#pragma once
+#include "simulation.hpp"
+#include <filesystem>
+
+// Replay files are a small header followed by one varint per recorded action:
+//   "TRPL", version, randomizer mode, varint tick rate,
+//   varint seed, varint record count, varint final tick, varint final score, varint pieces placed,
+//   records: varint((tick delta << 3) | action)
+constexpr std::array<uint8_t, 4> REPLAY_MAGIC{'T', 'R', 'P', 'L'};
+constexpr uint8_t REPLAY_VERSION{3};
+
+struct ReplayHeader
+{
+    uint64_t seed{};
+    RandomizerMode mode{RandomizerMode::BAG_7};
+    uint64_t recordCount{};
+    uint64_t finalTick{};
+    uint64_t finalScore{};
+    uint64_t piecesPlaced{};
+};
+
+struct ReplayEvent
+{
+    uint64_t tick{};
+    Action action{};
+};
+
+class ReplayWriter
+{
+public:
+    ReplayWriter(uint64_t _seed, RandomizerMode _mode) : seed(_seed), mode(_mode) {}
+
+    void record(uint64_t tick, Action action);
+    std::vector<uint8_t> serialize(const Simulation &simulation) const;
+    void save(const std::filesystem::path &path, const Simulation &simulation) const;
+
+private:
+    uint64_t seed;
+    RandomizerMode mode;
+    uint64_t recordCount{};
+    uint64_t lastTick{};
+    std::vector<uint8_t> records;
+};
+
+// Decodes records straight out of a caller-owned buffer, typically a MappedFile
+class ReplayReader
+{
+public:
+    ReplayReader(const uint8_t *data, size_t size);
+
+    const ReplayHeader &getHeader() const { return header; }
+    bool next(ReplayEvent &event);
+
+private:
+    uint64_t readVarint();
+
+    const uint8_t *cursor;
+    const uint8_t *end;
+    ReplayHeader header;
+    uint64_t recordsLeft{};
+    uint64_t tick{};
+};
+
+// Plays a replay to its final tick without any frame pacing
+Simulation playReplay(ReplayReader &reader);
+bool verifyReplay(ReplayReader &reader);
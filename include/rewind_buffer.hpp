@@ -0,0 +1,22 @@
+#pragma once
+#include "simulation.hpp"
+
+// Most recent game states, one per tick; once full the oldest is overwritten
+class RewindBuffer
+{
+public:
+    explicit RewindBuffer(size_t capacity);
+
+    void push(const GameState &state);
+    // Takes back the newest state, false once every stored state has been taken
+    bool pop(GameState &state);
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return states.size(); }
+
+private:
+    std::vector<GameState> states;
+    size_t next{};
+    size_t count{};
+};
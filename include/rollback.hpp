@@ -0,0 +1,70 @@
+#pragma once
+#include "versus_match.hpp"
+
+// Furthest the local match may run ahead of the last confirmed remote input
+constexpr uint32_t MAX_ROLLBACK_TICKS{60};
+// Inputs kept per player; must cover twice the rollback window, which bounds unacknowledged local inputs
+constexpr uint32_t INPUT_HISTORY{256};
+constexpr uint32_t SNAPSHOT_HISTORY{64};
+static_assert(SNAPSHOT_HISTORY > MAX_ROLLBACK_TICKS && INPUT_HISTORY >= 2 * MAX_ROLLBACK_TICKS + 2);
+
+struct RollbackStats
+{
+    uint64_t rollbacks{};
+    uint64_t resimulatedTicks{};
+    uint32_t deepestRollback{};
+};
+
+// GGPO-style synchronization of a versus match, independent of the transport.
+// The local player's input is applied on the tick it is made; the remote
+// player's is predicted to repeat its last confirmed input. When a confirmed
+// remote input disagrees with the prediction, the match is restored to the
+// snapshot before that tick and simulated forward again.
+class RollbackSession
+{
+public:
+    RollbackSession(uint8_t _localPlayer, uint64_t seed, const std::array<InputSettings, VERSUS_PLAYERS> &settings);
+
+    // False while the remote player is a full rollback window behind
+    bool canAdvance() const { return tick < remoteConfirmed + MAX_ROLLBACK_TICKS; }
+    // Runs one tick with the local held buttons; returns the local player's events
+    uint8_t advance(uint8_t localHeld);
+    // Remote inputs must arrive in tick order; ones already confirmed are ignored
+    void receiveRemote(uint32_t remoteTick, uint8_t held);
+    // Re-simulates from the earliest misprediction, if any
+    void resolve();
+
+    uint8_t getLocalPlayer() const { return localPlayer; }
+    uint32_t getTick() const { return tick; }
+    // Number of remote inputs received so far, all of them contiguous from tick 0
+    uint32_t getRemoteConfirmed() const { return remoteConfirmed; }
+    uint8_t getLocalInput(uint32_t inputTick) const { return inputs[localPlayer][inputTick % INPUT_HISTORY]; }
+    const VersusMatch &getMatch() const { return match; }
+    const RollbackStats &getStats() const { return stats; }
+
+    // Checksum of the state at the start of a tick both sides have confirmed, if still kept
+    std::optional<uint64_t> getChecksum(uint32_t checksumTick) const;
+    uint32_t getLastChecksumTick() const { return checksummedTo; }
+
+private:
+    uint8_t remotePlayer() const { return 1 - localPlayer; }
+    uint8_t predictedRemote() const;
+    void step(bool resimulating);
+    void recordChecksums();
+
+    uint8_t localPlayer;
+    VersusMatch match;
+
+    // Index tick % size; snapshots are taken before the tick's inputs are applied
+    std::array<VersusState, SNAPSHOT_HISTORY> snapshots;
+    std::array<std::array<uint8_t, INPUT_HISTORY>, VERSUS_PLAYERS> inputs{};
+    std::array<uint64_t, SNAPSHOT_HISTORY> checksums{};
+
+    uint32_t tick{};
+    uint32_t remoteConfirmed{};
+    std::optional<uint32_t> rollbackFrom;
+    uint32_t checksummedTo{};
+    uint8_t localEvents{};
+
+    RollbackStats stats;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include "game_manager.hpp"
+
+enum class Action : uint8_t
+{
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    SOFT_DROP,
+    HARD_DROP,
+    ROTATE_CW,
+    ROTATE_CCW,
+    HOLD,
+    RESET
+};
+constexpr uint8_t ACTION_COUNT{8};
+
+// Bit flags reported by Simulation::apply and Simulation::tick
+enum SimulationEvent : uint8_t
+{
+    EVENT_NONE = 0,
+    EVENT_ROTATED = 1 << 0,
+    EVENT_HARD_DROPPED = 1 << 1,
+    EVENT_HELD = 1 << 2,
+    EVENT_HOLD_FAILED = 1 << 3,
+    EVENT_LOCKED = 1 << 4,
+    EVENT_TOPPED_OUT = 1 << 5,
+    EVENT_RESET = 1 << 6
+};
+
+// Every piece of mutable game state, flat so a snapshot or restore is one copy
+struct GameState
+{
+    GameManager gameManager;
+    Tetromino currentTetromino;
+    PieceQueue queue;
+
+    bool grounded;
+    bool wasGrounded;
+    uint16_t gravityElapsed;
+    uint16_t lockDelayElapsed;
+    uint8_t lockCounter;
+
+    std::array<uint8_t, GRID_HEIGHT> garbageHoles;
+    uint8_t garbagePending;
+    uint8_t garbageOutgoing;
+
+    uint64_t tickCount;
+    uint64_t piecesPlaced;
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>, "GameState must be copyable with memcpy");
+
+// Window-free game rules, advanced one tick at a time at TICK_RATE
+class Simulation
+{
+public:
+    explicit Simulation(uint64_t seed = 0, RandomizerMode mode = RandomizerMode::BAG_7);
+
+    void reset();
+    uint8_t apply(Action action);
+    uint8_t tick();
+
+    const GameManager &getGameManager() const { return gameManager; }
+    const Tetromino &getCurrentTetromino() const { return currentTetromino; }
+    const PieceQueue &getQueue() const { return queue; }
+    Tetromino getGhostTetromino() const;
+
+    uint64_t getTickCount() const { return tickCount; }
+    uint64_t getPiecesPlaced() const { return piecesPlaced; }
+    uint16_t gravityDelayTicks() const;
+
+    GameState snapshot() const;
+    void restore(const GameState &state);
+
+    // Versus play: incoming lines wait until a lock that clears nothing, and
+    // clears first cancel pending lines before the rest is sent out
+    void receiveGarbage(uint8_t lines, uint8_t holeColumn);
+    uint8_t takeOutgoingGarbage();
+    uint8_t getGarbagePending() const { return garbagePending; }
+
+private:
+    void lockPiece(uint8_t &events);
+    bool exchangeGarbage(uint8_t rowsCleared);
+    uint16_t lockDelayTicks() const;
+
+    GameManager gameManager;
+    Tetromino currentTetromino;
+    PieceQueue queue;
+
+    bool grounded{false};
+    bool wasGrounded{grounded};
+
+    uint16_t gravityElapsed{};
+    uint16_t lockDelayElapsed{};
+    uint8_t lockCounter{};
+
+    // Hole column of each pending garbage line, oldest first
+    std::array<uint8_t, GRID_HEIGHT> garbageHoles{};
+    uint8_t garbagePending{};
+    uint8_t garbageOutgoing{};
+
+    uint64_t tickCount{};
+    uint64_t piecesPlaced{};
+
+    // Ghost is recomputed only after the active piece moves or the board changes
+    mutable std::optional<Tetromino> ghostSource;
+    mutable Tetromino ghostTetromino;
+};
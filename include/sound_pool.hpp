@@ -0,0 +1,88 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+enum SoundId : uint8_t
+{
+    SOUND_ROTATE,
+    SOUND_HARD_DROP,
+    SOUND_HOLD,
+    SOUND_INVALID,
+    SOUND_COUNT
+};
+
+struct SoundSettings
+{
+    float volume;
+    // Voices the effect may hold at once; a further trigger restarts its oldest voice
+    uint8_t maxVoices;
+};
+
+constexpr std::array<SoundSettings, SOUND_COUNT> SOUND_SETTINGS{{
+    {40.0f, 4},
+    {50.0f, 3},
+    {50.0f, 2},
+    {25.0f, 1},
+}};
+
+// Voices shared by every effect, created once and reused
+constexpr size_t SOUND_VOICE_COUNT{12};
+// Triggers waiting for the audio thread; a full queue drops the newest
+constexpr size_t SOUND_QUEUE_CAPACITY{64};
+
+// Plays short effects from buffers decoded to PCM at load time. The game
+// thread only pushes the effect onto a single-producer ring; a dedicated
+// audio thread pops it and starts a voice, so the game thread never waits on
+// the audio device. Every trigger must come from the same thread.
+class SoundPool
+{
+public:
+    SoundPool();
+    ~SoundPool();
+
+    SoundPool(const SoundPool &) = delete;
+    SoundPool &operator=(const SoundPool &) = delete;
+
+    // Filled by a loader thread, then published with markLoaded once the load has been joined
+    sf::SoundBuffer &getBuffer(SoundId id) { return buffers[id]; }
+    void markLoaded(SoundId id) { loaded[id].store(true, std::memory_order_release); }
+
+    // Lock-free unless the audio thread is asleep, which costs one wakeup
+    void play(SoundId id);
+
+private:
+    struct Voice
+    {
+        std::optional<sf::Sound> sound;
+        SoundId id{SOUND_COUNT};
+        uint64_t startedAt{};
+    };
+
+    bool isPlaying(const Voice &voice) const;
+    Voice &pickVoice(SoundId id);
+    void start(SoundId id);
+    void audioLoop();
+
+    std::array<sf::SoundBuffer, SOUND_COUNT> buffers;
+    std::array<std::atomic<bool>, SOUND_COUNT> loaded{};
+
+    std::array<SoundId, SOUND_QUEUE_CAPACITY> queue{};
+    std::atomic<size_t> head{};
+    std::atomic<size_t> tail{};
+
+    // Only touched by the audio thread
+    std::array<Voice, SOUND_VOICE_COUNT> voices;
+    uint64_t startCount{};
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping{false};
+    bool stopping{false};
+    std::thread audioThread;
+};
@@ -1,28 +1,120 @@
 #pragma once
-#include "common.hpp"
+#include "board.hpp"
+#include <type_traits>
 
-class Tetromino
+enum class PieceType : uint8_t
 {
-public:
-    Tetromino() : squareSize{},
-                  id{},
-                  color{},
-                  piece{},
-                  pos{0, 0},
-                  rotationIndex{} {}
-    Tetromino(int _squareSize, char _id, Color _color)
-        : squareSize(_squareSize), id(_id), color(_color), piece(_squareSize, std::vector<Color>(_squareSize, EMPTY))
-    {
-    }
+    NONE,
+    O,
+    I,
+    S,
+    Z,
+    L,
+    J,
+    T
+};
+constexpr uint8_t PIECE_TYPE_COUNT{8};
 
+// Spawn orientation of each piece, bit j of row i is column j of its bounding box
+struct PieceShape
+{
     uint8_t squareSize;
-    char id;
     Color color;
-    std::vector<std::vector<Color>> piece;
-    Position pos{};
+    PieceMask mask;
+};
+
+constexpr std::array<PieceShape, PIECE_TYPE_COUNT> pieceShapes{{
+    {0, EMPTY, {0b0000, 0b0000, 0b0000, 0b0000}},
+    {2, YELLOW, {0b0011, 0b0011, 0b0000, 0b0000}},
+    {4, CYAN, {0b0000, 0b1111, 0b0000, 0b0000}},
+    {3, GREEN, {0b0110, 0b0011, 0b0000, 0b0000}},
+    {3, RED, {0b0011, 0b0110, 0b0000, 0b0000}},
+    {3, ORANGE, {0b0100, 0b0111, 0b0000, 0b0000}},
+    {3, BLUE, {0b0001, 0b0111, 0b0000, 0b0000}},
+    {3, PURPLE, {0b0010, 0b0111, 0b0000, 0b0000}},
+}};
+
+constexpr PieceMask rotateMaskCW(const PieceMask &mask, uint8_t squareSize)
+{
+    PieceMask rotated{};
+    for (int i = 0; i < squareSize; i++)
+    {
+        for (int j = 0; j < squareSize; j++)
+        {
+            if (mask[i] & (1u << j))
+                rotated[j] |= 1u << (squareSize - 1 - i);
+        }
+    }
+    return rotated;
+}
+
+constexpr std::array<std::array<PieceMask, 4>, PIECE_TYPE_COUNT> buildPieceMasks()
+{
+    std::array<std::array<PieceMask, 4>, PIECE_TYPE_COUNT> masks{};
+    for (int type = 0; type < PIECE_TYPE_COUNT; type++)
+    {
+        masks[type][0] = pieceShapes[type].mask;
+        for (int rotation = 1; rotation < 4; rotation++)
+            masks[type][rotation] = rotateMaskCW(masks[type][rotation - 1], pieceShapes[type].squareSize);
+    }
+    return masks;
+}
+
+// All 7 pieces x 4 rotations, indexed by [type][rotationIndex]
+constexpr std::array<std::array<PieceMask, 4>, PIECE_TYPE_COUNT> pieceMasks{buildPieceMasks()};
+
+// Lowest filled row of each bounding-box column, NO_CELL where the column is empty
+constexpr int8_t NO_CELL{-1};
+using PieceProfile = std::array<int8_t, 4>;
+
+constexpr std::array<std::array<PieceProfile, 4>, PIECE_TYPE_COUNT> buildBottomProfiles()
+{
+    std::array<std::array<PieceProfile, 4>, PIECE_TYPE_COUNT> profiles{};
+    for (int type = 0; type < PIECE_TYPE_COUNT; type++)
+    {
+        for (int rotation = 0; rotation < 4; rotation++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                profiles[type][rotation][j] = NO_CELL;
+                for (int i = 0; i < 4; i++)
+                {
+                    if (pieceMasks[type][rotation][i] & (1u << j))
+                        profiles[type][rotation][j] = static_cast<int8_t>(i);
+                }
+            }
+        }
+    }
+    return profiles;
+}
+
+constexpr std::array<std::array<PieceProfile, 4>, PIECE_TYPE_COUNT> pieceBottoms{buildBottomProfiles()};
+
+class Tetromino
+{
+public:
+    constexpr Tetromino() = default;
+    constexpr explicit Tetromino(PieceType _type) : type(_type) {}
+
+    PieceType type{PieceType::NONE};
     int8_t rotationIndex{};
+    Position pos{};
+
+    uint8_t squareSize() const { return pieceShapes[static_cast<uint8_t>(type)].squareSize; }
+    Color color() const { return pieceShapes[static_cast<uint8_t>(type)].color; }
+    const PieceMask &mask() const { return pieceMasks[static_cast<uint8_t>(type)][rotationIndex]; }
+    const PieceProfile &bottom() const { return pieceBottoms[static_cast<uint8_t>(type)][rotationIndex]; }
+    bool isFilled(int row, int column) const { return mask()[row] & (1u << column); }
 
     void initializePosition();
-    Tetromino rotatedCCW();
-    Tetromino rotatedCW();
-};
\ No newline at end of file
+    Tetromino rotatedCCW() const;
+    Tetromino rotatedCW() const;
+
+    bool operator==(const Tetromino &other) const
+    {
+        return type == other.type && rotationIndex == other.rotationIndex && pos.x == other.pos.x && pos.y == other.pos.y;
+    }
+    bool operator!=(const Tetromino &other) const { return !(*this == other); }
+};
+
+static_assert(std::is_trivially_copyable_v<Tetromino>, "Tetromino must stay a plain value type");
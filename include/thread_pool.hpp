@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each owning a task deque. A worker runs its own newest
+// task first and, once its deque is empty, steals the oldest task of another
+// worker, so a few long tasks never leave the remaining cores idle.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Tasks submitted from a worker go to that worker's deque, others are spread round-robin
+    void submit(std::function<void()> task);
+    // Blocks until every submitted task has finished, rethrowing the first exception a task threw
+    void wait();
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(threads.size()); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popTask(unsigned index, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<size_t> queued{};
+    std::atomic<size_t> pending{};
+    std::atomic<unsigned> nextWorker{};
+    bool stopping{false};
+    std::exception_ptr firstError;
+};
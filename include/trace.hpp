@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct TraceEvent
+{
+    const char *name{};
+    uint64_t startNs{};
+    uint64_t durationNs{};
+    uint32_t threadId{};
+};
+
+// Newest events kept in the ring; older ones are overwritten
+constexpr size_t TRACE_CAPACITY{1 << 16};
+
+// Checked by every scope before touching the tracer, so disabled scopes stay a single load
+inline std::atomic<bool> traceEnabled{false};
+
+// Process-wide ring buffer of timed scopes. Recording is lock-free and safe from
+// any thread: a writer claims a slot with one atomic increment and publishes it
+// through the slot's sequence number, so a dump taken mid-write skips that slot
+// instead of blocking the writer. Nothing is recorded until tracing is enabled.
+class Tracer
+{
+public:
+    static Tracer &instance();
+
+    void setEnabled(bool enabled) { traceEnabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return traceEnabled.load(std::memory_order_relaxed); }
+
+    uint64_t now() const;
+    void record(const char *name, uint64_t startNs, uint64_t endNs);
+
+    // Completed events still in the ring, oldest first
+    std::vector<TraceEvent> snapshot() const;
+    // Chrome trace event JSON, loadable in chrome://tracing and Perfetto
+    void writeChromeTrace(const std::filesystem::path &path) const;
+
+private:
+    Tracer();
+
+    struct Slot
+    {
+        // Odd while the slot is being written, otherwise twice the event count it holds plus two
+        std::atomic<uint64_t> sequence{};
+        std::atomic<const char *> name{};
+        std::atomic<uint64_t> startNs{};
+        std::atomic<uint64_t> durationNs{};
+        std::atomic<uint32_t> threadId{};
+    };
+
+    std::array<Slot, TRACE_CAPACITY> slots;
+    std::atomic<uint64_t> head{};
+    const std::chrono::steady_clock::time_point origin;
+};
+
+// Records the lifetime of the enclosing scope under a static name
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char *_name)
+        : name(traceEnabled.load(std::memory_order_relaxed) ? _name : nullptr), startNs(name ? Tracer::instance().now() : 0) {}
+    ~ScopedTimer()
+    {
+        if (name)
+            Tracer::instance().record(name, startNs, Tracer::instance().now());
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    const char *name;
+    uint64_t startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#ifdef TETRIS_ENABLE_TRACING
+#define TRACE_SCOPE(name) const ScopedTimer TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+// Durations of the most recent frames, for percentile readouts
+class FrameTimeStats
+{
+public:
+    static constexpr size_t CAPACITY{256};
+
+    void add(float milliseconds);
+    // Nearest-rank percentile over the stored frames, 0 when there are none
+    float percentile(float fraction) const;
+
+private:
+    std::array<float, CAPACITY> samples{};
+    size_t count{};
+    size_t next{};
+    mutable std::array<float, CAPACITY> scratch{};
+};
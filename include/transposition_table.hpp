@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// Entries per bucket; a bucket of 16-byte entries fills one cache line
+constexpr size_t TABLE_BUCKET_SIZE{4};
+
+struct TableHit
+{
+    uint64_t value;
+    uint8_t depth;
+};
+
+// Fixed-size hash table of search results keyed by Zobrist hashes, shared by
+// any number of search threads without locks. Each entry is two relaxed atomic
+// words, the value and its key XOR value with the depth and generation in the
+// low 16 bits. A probe that reads one thread's value with another thread's key
+// fails the XOR check and counts as a miss, so torn entries are never returned.
+// A store replaces the same position if it is no shallower, and otherwise the
+// entry that is shallowest once older searches are marked down.
+class TranspositionTable
+{
+public:
+    // Rounded down to a power of two buckets, at least one
+    explicit TranspositionTable(size_t megabytes);
+
+    std::optional<TableHit> probe(uint64_t key) const;
+    void store(uint64_t key, uint64_t value, uint8_t depth);
+    // Ages every entry by one search, so the next search's results replace them first
+    void newSearch() { generation.fetch_add(1, std::memory_order_relaxed); }
+    void clear();
+
+    size_t getCapacity() const { return (bucketMask + 1) * TABLE_BUCKET_SIZE; }
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check{};
+        std::atomic<uint64_t> value{};
+    };
+    struct alignas(64) Bucket
+    {
+        Entry entries[TABLE_BUCKET_SIZE];
+    };
+
+    size_t bucketMask;
+    std::unique_ptr<Bucket[]> buckets;
+    std::atomic<uint8_t> generation{};
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IPv4 address and port, both in host byte order
+struct UdpAddress
+{
+    uint32_t ip{};
+    uint16_t port{};
+
+    bool operator==(const UdpAddress &other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const UdpAddress &other) const { return !(*this == other); }
+};
+
+// Resolves "host:port", for example "127.0.0.1:7000" or "localhost:7000"
+UdpAddress resolveUdpAddress(const std::string &hostAndPort);
+
+// Non-blocking IPv4 datagram socket
+class UdpSocket
+{
+public:
+    // Port 0 lets the system pick one
+    explicit UdpSocket(uint16_t port = 0);
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket &) = delete;
+    UdpSocket &operator=(const UdpSocket &) = delete;
+
+    void send(const UdpAddress &to, const uint8_t *data, size_t size);
+    // False when no datagram is waiting
+    bool receive(uint8_t *buffer, size_t capacity, size_t &size, UdpAddress &from);
+
+private:
+#ifdef _WIN32
+    uintptr_t handle;
+#else
+    int handle;
+#endif
+};
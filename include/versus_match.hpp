@@ -0,0 +1,55 @@
+#pragma once
+#include "input.hpp"
+
+constexpr uint8_t VERSUS_PLAYERS{2};
+
+enum class VersusResult : uint8_t
+{
+    PLAYING,
+    FIRST_WON,
+    SECOND_WON,
+    DRAW
+};
+
+// Everything a versus match needs to carry on from a tick, flat so rollback can copy it
+struct VersusState
+{
+    std::array<GameState, VERSUS_PLAYERS> games;
+    std::array<InputHandler, VERSUS_PLAYERS> handlers;
+    Xoshiro256 garbageRng;
+    uint32_t tick;
+    VersusResult result;
+};
+
+static_assert(std::is_trivially_copyable_v<VersusState>, "VersusState must be copyable with memcpy");
+
+// Two boards on the same piece sequence, advanced in lockstep from each
+// player's held buttons. Cleared lines send garbage to the other board, and
+// the first player to top out loses. Given the same seed and inputs every
+// peer computes the same match, which is what rollback relies on.
+class VersusMatch
+{
+public:
+    VersusMatch(uint64_t seed, const std::array<InputSettings, VERSUS_PLAYERS> &settings);
+
+    // Held buttons are masks with bit n for Action n; returns each player's events
+    std::array<uint8_t, VERSUS_PLAYERS> advance(const std::array<uint8_t, VERSUS_PLAYERS> &held);
+
+    VersusState snapshot() const;
+    void restore(const VersusState &state);
+
+    const Simulation &getPlayer(uint8_t player) const { return players[player]; }
+    uint32_t getTick() const { return tick; }
+    VersusResult getResult() const { return result; }
+
+private:
+    std::array<Simulation, VERSUS_PLAYERS> players;
+    std::array<InputHandler, VERSUS_PLAYERS> handlers;
+    Xoshiro256 garbageRng;
+    uint32_t tick{};
+    VersusResult result{VersusResult::PLAYING};
+    std::vector<Action> actions;
+};
+
+// Hash of the state both peers must agree on, compared to catch desyncs
+uint64_t versusChecksum(const VersusState &state);
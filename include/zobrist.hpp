@@ -0,0 +1,64 @@
+#pragma once
+#include "common.hpp"
+
+// Zobrist keys are splitmix64 of a fixed index, so they are the same in every
+// build and on every machine. Each kind of feature has its own index range.
+constexpr uint64_t zobristKey(uint64_t index)
+{
+    uint64_t z{(index + 1) * 0x9E3779B97F4A7C15ull};
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr uint64_t ZOBRIST_CELL_KEYS{0};
+constexpr uint64_t ZOBRIST_PIECE_KEYS{1ull << 32};
+constexpr uint64_t ZOBRIST_HOLD_KEYS{2ull << 32};
+constexpr uint64_t ZOBRIST_QUEUE_KEYS{3ull << 32};
+constexpr uint64_t ZOBRIST_EXTRA_KEYS{4ull << 32};
+
+// Key of the filled cell at stored row, column
+constexpr uint64_t zobristCell(int row, int column)
+{
+    return zobristKey(ZOBRIST_CELL_KEYS + static_cast<uint64_t>(row) * 64 + static_cast<uint64_t>(column));
+}
+
+// A row's hash is the XOR of its filled cells' keys, looked up four columns at a time
+template <uint8_t W, int Rows>
+struct ZobristRowTable
+{
+    static constexpr int CHUNKS{(W + 3) / 4};
+    std::array<std::array<std::array<uint64_t, 16>, CHUNKS>, Rows> nibbles{};
+
+    constexpr ZobristRowTable()
+    {
+        for (int row = 0; row < Rows; row++)
+        {
+            for (int chunk = 0; chunk < CHUNKS; chunk++)
+            {
+                for (int bits = 0; bits < 16; bits++)
+                {
+                    uint64_t hash{};
+                    for (int bit = 0; bit < 4; bit++)
+                    {
+                        if ((bits & (1 << bit)) && chunk * 4 + bit < W)
+                            hash ^= zobristCell(row, chunk * 4 + bit);
+                    }
+                    nibbles[row][chunk][bits] = hash;
+                }
+            }
+        }
+    }
+
+    template <typename Row>
+    uint64_t hash(int row, Row cells) const
+    {
+        uint64_t result{};
+        for (int chunk = 0; chunk < CHUNKS; chunk++)
+            result ^= nibbles[row][chunk][(cells >> (chunk * 4)) & 0xF];
+        return result;
+    }
+};
+
+template <uint8_t W, int Rows>
+inline constexpr ZobristRowTable<W, Rows> ZOBRIST_ROWS{};
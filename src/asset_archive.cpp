@@ -0,0 +1,124 @@
+#include "asset_archive.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+static void writeVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t readVarint(const uint8_t *&cursor, const uint8_t *end)
+{
+    uint64_t value{};
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (cursor == end)
+        {
+            throw std::runtime_error("Truncated asset archive.\n");
+        }
+        const uint8_t byte{*cursor++};
+        value |= uint64_t{byte & 0x7Fu} << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    throw std::runtime_error("Malformed varint in asset archive.\n");
+}
+
+AssetArchive::AssetArchive(const uint8_t *data, size_t size)
+{
+    const uint8_t *cursor{data};
+    const uint8_t *end{data + size};
+    if (size < ARCHIVE_MAGIC.size() + 1 || !std::equal(ARCHIVE_MAGIC.begin(), ARCHIVE_MAGIC.end(), data))
+    {
+        throw std::runtime_error("Not an asset archive.\n");
+    }
+    cursor += ARCHIVE_MAGIC.size();
+    if (*cursor++ != ARCHIVE_VERSION)
+    {
+        throw std::runtime_error("Unsupported asset archive version.\n");
+    }
+
+    const uint64_t count{readVarint(cursor, end)};
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const uint64_t nameLength{readVarint(cursor, end)};
+        if (nameLength > static_cast<uint64_t>(end - cursor))
+        {
+            throw std::runtime_error("Truncated asset archive.\n");
+        }
+        const std::string_view name{reinterpret_cast<const char *>(cursor), nameLength};
+        cursor += nameLength;
+
+        const uint64_t offset{readVarint(cursor, end)};
+        const uint64_t entrySize{readVarint(cursor, end)};
+        if (offset > size || entrySize > size - offset)
+        {
+            throw std::runtime_error("Asset " + std::string(name) + " lies outside the archive.\n");
+        }
+        entries.push_back({name, data + offset, entrySize});
+    }
+}
+
+const AssetEntry &AssetArchive::get(std::string_view name) const
+{
+    const auto entry{std::find_if(entries.begin(), entries.end(), [name](const AssetEntry &candidate)
+                                  { return candidate.name == name; })};
+    if (entry == entries.end())
+    {
+        throw std::runtime_error("Asset " + std::string(name) + " is missing from the archive.\n");
+    }
+    return *entry;
+}
+
+std::vector<uint8_t> packAssets(const std::vector<std::filesystem::path> &roots)
+{
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> files;
+    for (const std::filesystem::path &root : roots)
+    {
+        for (const auto &item : std::filesystem::recursive_directory_iterator(root))
+        {
+            if (!item.is_regular_file())
+                continue;
+            std::ifstream file(item.path(), std::ios::binary);
+            if (!file)
+            {
+                throw std::runtime_error("Failed to read asset " + item.path().string() + ".\n");
+            }
+            const std::string name{(root.filename() / item.path().lexically_relative(root)).generic_string()};
+            files.emplace_back(name, std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {}));
+        }
+    }
+    // Sorted names keep the archive byte-identical between builds
+    std::sort(files.begin(), files.end());
+
+    // Offsets depend on the index size, so the index is laid out until it stops growing
+    std::vector<uint8_t> index;
+    size_t indexSize{};
+    do
+    {
+        indexSize = index.size();
+        index.assign(ARCHIVE_MAGIC.begin(), ARCHIVE_MAGIC.end());
+        index.push_back(ARCHIVE_VERSION);
+        writeVarint(index, files.size());
+        uint64_t offset{indexSize};
+        for (const auto &[name, bytes] : files)
+        {
+            writeVarint(index, name.size());
+            index.insert(index.end(), name.begin(), name.end());
+            writeVarint(index, offset);
+            writeVarint(index, bytes.size());
+            offset += bytes.size();
+        }
+    } while (index.size() != indexSize);
+
+    for (const auto &file : files)
+        index.insert(index.end(), file.second.begin(), file.second.end());
+    return index;
+}
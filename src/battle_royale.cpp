@@ -0,0 +1,159 @@
+#include "battle_royale.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+BattleRoyale::BattleRoyale(uint8_t playerCount, uint64_t seed, ThreadPool &_pool)
+    : pool(_pool), placements(playerCount), survivors(playerCount), rng(seed)
+{
+    if (playerCount < 2 || playerCount > ROYALE_MAX_PLAYERS)
+    {
+        throw std::runtime_error("A battle royale needs 2 to " + std::to_string(ROYALE_MAX_PLAYERS) + " players.\n");
+    }
+    bots.reserve(playerCount - 1);
+    for (uint8_t i = 1; i < playerCount; i++)
+    {
+        const float piecesPerSecond{ROYALE_MIN_BOT_PPS + (ROYALE_MAX_BOT_PPS - ROYALE_MIN_BOT_PPS) * rng.below(1000) / 1000.0f};
+        bots.push_back({Simulation(seed), Bot(), static_cast<uint16_t>(TICK_RATE / piecesPerSecond)});
+    }
+    shownBoards.resize(bots.size());
+    shownEliminated.resize(bots.size());
+}
+
+BattleRoyale::~BattleRoyale()
+{
+    // The pool outlives the match, so no task may still hold a bot
+    if (running)
+    {
+        try
+        {
+            pool.wait();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void BattleRoyale::advance(RoyaleBot &royaleBot, uint32_t ticks)
+{
+    for (uint32_t i = 0; i < ticks && !royaleBot.toppedOut; i++)
+    {
+        uint8_t events{EVENT_NONE};
+        if (++royaleBot.thinkElapsed >= royaleBot.thinkTicks)
+        {
+            events |= royaleBot.bot.playPiece(royaleBot.simulation);
+            royaleBot.thinkElapsed = 0;
+        }
+        events |= royaleBot.simulation.tick();
+        royaleBot.attack += royaleBot.simulation.takeOutgoingGarbage();
+        royaleBot.toppedOut = (events & EVENT_TOPPED_OUT) != 0;
+    }
+}
+
+void BattleRoyale::start(uint32_t ticks)
+{
+    TRACE_SCOPE("BattleRoyale::start");
+    for (size_t first = 0; first < bots.size(); first += ROYALE_BOTS_PER_TASK)
+    {
+        const size_t last{std::min(first + ROYALE_BOTS_PER_TASK, bots.size())};
+        pool.submit([this, first, last, ticks]
+                    {
+                        for (size_t i = first; i < last; i++)
+                        {
+                            if (!placements[i + 1])
+                                advance(bots[i], ticks);
+                        } });
+    }
+    elapsedTicks += ticks;
+    running = true;
+}
+
+void BattleRoyale::eliminate(uint8_t player)
+{
+    placements[player] = survivors--;
+    if (survivors == 1)
+    {
+        for (uint8_t i = 0; i < placements.size(); i++)
+        {
+            if (!placements[i])
+                placements[i] = 1;
+        }
+    }
+}
+
+// A random surviving player other than the attacker, or the attacker itself once it is the last one
+uint8_t BattleRoyale::pickTarget(uint8_t attacker)
+{
+    if (survivors < 2)
+        return attacker;
+    uint32_t skip{rng.below(survivors - 1u)};
+    for (uint8_t i = 0; i < placements.size(); i++)
+    {
+        if (i == attacker || placements[i])
+            continue;
+        if (skip-- == 0)
+            return i;
+    }
+    return attacker;
+}
+
+void BattleRoyale::sendGarbage(uint8_t target, uint8_t lines)
+{
+    const uint8_t hole{static_cast<uint8_t>(rng.below(GRID_WIDTH))};
+    if (target == 0)
+        humanGarbage.emplace_back(lines, hole);
+    else
+        bots[target - 1].simulation.receiveGarbage(lines, hole);
+}
+
+void BattleRoyale::finish(uint8_t humanAttack, bool humanToppedOut)
+{
+    TRACE_SCOPE("BattleRoyale::finish");
+    if (running)
+    {
+        running = false;
+        pool.wait();
+    }
+
+    // Eliminations and attacks are settled in player order, so the outcome never depends on thread timing
+    humanGarbage.clear();
+    if (humanToppedOut && !placements[0] && survivors > 1)
+        eliminate(0);
+    for (size_t i = 0; i < bots.size(); i++)
+    {
+        if (bots[i].toppedOut && !placements[i + 1] && survivors > 1)
+            eliminate(static_cast<uint8_t>(i + 1));
+    }
+
+    const auto attack{[this](uint8_t attacker, uint8_t lines)
+                      {
+                          const uint8_t target{pickTarget(attacker)};
+                          if (lines > 0 && target != attacker)
+                              sendGarbage(target, lines);
+                      }};
+    if (!placements[0])
+        attack(0, humanAttack);
+    for (size_t i = 0; i < bots.size(); i++)
+    {
+        if (!placements[i + 1])
+            attack(static_cast<uint8_t>(i + 1), bots[i].attack);
+        bots[i].attack = 0;
+    }
+
+    while (survivors > 1 && elapsedTicks >= (surges + 1u) * uint64_t{ROYALE_SURGE_TICKS})
+    {
+        surges++;
+        for (uint8_t i = 0; i < placements.size(); i++)
+        {
+            if (!placements[i])
+                sendGarbage(i, static_cast<uint8_t>(std::min<uint32_t>(surges, GARBAGE_PER_LOCK)));
+        }
+    }
+
+    for (size_t i = 0; i < bots.size(); i++)
+    {
+        shownBoards[i] = bots[i].simulation.getGameManager().board;
+        shownEliminated[i] = placements[i + 1] > 1;
+    }
+}
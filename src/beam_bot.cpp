@@ -0,0 +1,269 @@
+#include "beam_bot.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Past the depth keys perft uses; each search gets its own run of queue index keys,
+    // so a position only merges with others reached in the same search and ply
+    constexpr uint64_t BEAM_KEYS{ZOBRIST_EXTRA_KEYS + 256};
+    constexpr uint64_t BEAM_KEYS_PER_SEARCH{16};
+    // The root expansion comes before a move's first search and keys its positions, at
+    // queue index 0 or 1, by the last two keys of that search's run
+    constexpr uint64_t BEAM_ROOT_KEYS{BEAM_KEYS_PER_SEARCH - 2};
+    static_assert(BEAM_MAX_DEPTH < BEAM_ROOT_KEYS, "Queue indexes would reach the root expansion's keys");
+
+    uint64_t scoreBits(float score)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &score, sizeof(bits));
+        return bits;
+    }
+
+    float bitsScore(uint64_t value)
+    {
+        const uint32_t bits{static_cast<uint32_t>(value)};
+        float score;
+        std::memcpy(&score, &bits, sizeof(score));
+        return score;
+    }
+}
+
+BeamBot::BeamBot(const BeamSettings &_settings, const BotWeights &_weights, ThreadPool *_pool)
+    : settings(_settings), weights(_weights), pool(_pool), workers(_pool ? _pool->getThreadCount() : 1)
+{
+    if (settings.width == 0 || settings.depth == 0)
+    {
+        throw std::runtime_error("Beam width and depth must be at least 1.\n");
+    }
+}
+
+BeamPlan BeamBot::plan(const Simulation &simulation)
+{
+    const Clock::time_point deadline{Clock::now() + settings.budget};
+    queue.clear();
+    const PieceQueue &upcoming{simulation.getQueue()};
+    for (uint8_t i = 0; i < upcoming.size(); i++)
+        queue.push_back(upcoming[i].type);
+
+    BeamPlan result;
+    const Node root{simulation.getGameManager(), 0.0f, 0, 0};
+    Worker &first{workers[0]};
+    first.candidates.clear();
+    searchKeys = BEAM_KEYS + (searches + 1) * BEAM_KEYS_PER_SEARCH + BEAM_ROOT_KEYS;
+    expand(first, rootGenerator, root.gameManager, simulation.getCurrentTetromino(), 0, 0, 0.0f, std::nullopt);
+    result.expanded = 1;
+    if (first.candidates.empty())
+        return result;
+    rootPlacements = first.placements;
+    rootCandidates.swap(first.candidates);
+
+    // Lookahead expansions cost a fraction of the root's, so each worker times its own. Timings
+    // start over every move, or one preempted ply would cut short every search after it.
+    for (Worker &worker : workers)
+        worker.slowestExpansion = Clock::duration::zero();
+    selectionPerNode = Clock::duration::zero();
+
+    // Every beam searches as deep as the queue goes; a wider one replaces the last only if it finishes
+    std::optional<uint16_t> bestRoot;
+    for (uint16_t width = std::min(BEAM_FIRST_WIDTH, settings.width);; width = static_cast<uint16_t>(std::min(width * 2, int{settings.width})))
+    {
+        bool filled{false};
+        const std::optional<uint16_t> found{search(root, width, deadline, !bestRoot, filled, result)};
+        if (!found)
+            break;
+        bestRoot = found;
+        result.width = width;
+        // A beam that never filled up already held every line a wider one would
+        if (width == settings.width || !filled || Clock::now() >= deadline)
+            break;
+    }
+
+    rootGenerator.path(rootPlacements[*bestRoot], result.actions);
+    return result;
+}
+
+std::optional<uint16_t> BeamBot::search(const Node &root, uint16_t width, Clock::time_point deadline, bool acceptPartial, bool &filled, BeamPlan &result)
+{
+    table.newSearch();
+    searches++;
+    searchKeys = BEAM_KEYS + searches * BEAM_KEYS_PER_SEARCH;
+    beam.assign(1, root);
+    merged = rootCandidates;
+    filled = merged.size() > width;
+    keepBest(width);
+    uint16_t bestRoot{beam[0].root};
+    uint8_t plies{1};
+
+    const uint8_t depth{static_cast<uint8_t>(std::min<size_t>(settings.depth, queue.size() + 1))};
+    for (; plies < depth; plies++)
+    {
+        const size_t workerCount{std::min(workers.size(), beam.size())};
+        for (size_t w = 0; w < workerCount; w++)
+        {
+            workers[w].candidates.clear();
+            workers[w].expanded = 0;
+            workers[w].stopped = false;
+        }
+        // Expansions leave room for choosing the next beam, which takes time in proportion to its width
+        const Clock::time_point expandDeadline{deadline - selectionPerNode * width};
+        // Workers take the beam in strides, so each starts on the best positions it has
+        if (workerCount == 1)
+        {
+            expandRange(workers[0], 0, 1, expandDeadline);
+        }
+        else
+        {
+            for (size_t w = 0; w < workerCount; w++)
+                pool->submit([this, w, workerCount, expandDeadline] { expandRange(workers[w], w, workerCount, expandDeadline); });
+            pool->wait();
+        }
+
+        merged.clear();
+        bool stopped{false};
+        for (size_t w = 0; w < workerCount; w++)
+        {
+            merged.insert(merged.end(), workers[w].candidates.begin(), workers[w].candidates.end());
+            result.expanded += workers[w].expanded;
+            stopped |= workers[w].stopped;
+        }
+        if (stopped)
+        {
+            // Only the first beam settles for a ply cut short, picking its best line without building another beam
+            if (!acceptPartial)
+                return std::nullopt;
+            if (!merged.empty())
+                bestRoot = std::max_element(merged.begin(), merged.end(), [](const Candidate &a, const Candidate &b) { return a.score < b.score; })->root;
+            break;
+        }
+        if (merged.empty())
+            break;
+        filled |= merged.size() > width;
+        const Clock::time_point selectionStart{Clock::now()};
+        keepBest(width);
+        selectionPerNode = (Clock::now() - selectionStart) / beam.size();
+        bestRoot = beam[0].root;
+    }
+    result.depth = plies;
+    return bestRoot;
+}
+
+uint8_t BeamBot::playPiece(Simulation &simulation)
+{
+    const BeamPlan result{plan(simulation)};
+    if (result.actions.empty())
+        return simulation.apply(Action::HARD_DROP);
+
+    uint8_t events{EVENT_NONE};
+    for (Action action : result.actions)
+        events |= simulation.apply(action);
+    return events;
+}
+
+void BeamBot::expandRange(Worker &worker, size_t first, size_t stride, Clock::time_point deadline)
+{
+    for (size_t i = first; i < beam.size(); i += stride)
+    {
+        const Clock::time_point start{Clock::now()};
+        if (start + worker.slowestExpansion >= deadline)
+        {
+            worker.stopped = true;
+            return;
+        }
+
+        // A line that used up the known pieces, or that tops out, has nothing to expand
+        const Node &node{beam[i]};
+        if (node.queueIndex >= queue.size())
+            continue;
+        const std::optional<Tetromino> spawn{node.gameManager.newTetromino(Tetromino{queue[node.queueIndex]})};
+        if (!spawn)
+            continue;
+
+        expand(worker, worker.generator, node.gameManager, *spawn, static_cast<uint8_t>(node.queueIndex + 1), static_cast<uint16_t>(i), node.reward,
+               node.root);
+        worker.expanded++;
+        worker.slowestExpansion = std::max(worker.slowestExpansion, Clock::now() - start);
+    }
+}
+
+void BeamBot::expand(Worker &worker, MoveGenerator &generator, const GameManager &gameManager, const Tetromino &current, uint8_t holdIndex, uint16_t parent,
+                     float reward, std::optional<uint16_t> root)
+{
+    // Only the first move needs an input path; the plies below it look at hard drops
+    const Tetromino next{holdIndex < queue.size() ? Tetromino{queue[holdIndex]} : Tetromino{}};
+    const auto generate = [&](const GameManager &from)
+    {
+        if (root)
+            generator.generateDrops(from, current, next, worker.placements);
+        else
+            generator.generate(from, current, next, worker.placements);
+    };
+    if (gameManager.getHasHeld() || next.type != PieceType::NONE)
+    {
+        generate(gameManager);
+    }
+    else
+    {
+        // Holding with nothing held and nothing known after the current piece would play an unknown piece
+        GameManager noHold{gameManager};
+        noHold.setCanHold(false);
+        generate(noHold);
+    }
+
+    const std::vector<Placement> &placements{worker.placements};
+    worker.boards.assign(placements.size(), gameManager.board);
+    worker.linesCleared.resize(placements.size());
+    worker.features.resize(placements.size());
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        const Tetromino &tetromino{placements[i].tetromino};
+        worker.boards[i].place(tetromino.mask(), tetromino.pos.x, tetromino.pos.y, tetromino.color());
+        worker.linesCleared[i] = worker.boards[i].clearFullRows();
+    }
+    boardFeatures(worker.boards.data(), worker.linesCleared.data(), placements.size(), worker.features.data());
+
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        const Placement &placement{placements[i]};
+        const PieceType held{placement.usedHold ? current.type : gameManager.getHeldTetromino().type};
+        const uint8_t queueIndex{static_cast<uint8_t>(placement.usedHold && !gameManager.getHasHeld() ? holdIndex + 1 : holdIndex)};
+
+        const float lineReward{reward + weights[FEATURE_LINES_CLEARED] * worker.linesCleared[i]};
+        float score{lineReward};
+        for (uint8_t f = 0; f < BOT_FEATURE_COUNT; f++)
+        {
+            if (f != FEATURE_LINES_CLEARED)
+                score += weights[f] * worker.features[i][f];
+        }
+
+        // Another line already reached this board, hold piece and queue position at least as well
+        const uint64_t key{worker.boards[i].hash ^ zobristHold(held, true) ^ zobristKey(searchKeys + queueIndex)};
+        if (const std::optional<TableHit> hit{table.probe(key)}; hit && bitsScore(hit->value) >= score)
+            continue;
+        table.store(key, scoreBits(score), 0);
+
+        worker.candidates.push_back({score, lineReward, parent, root ? *root : static_cast<uint16_t>(i), placement.tetromino, held, queueIndex});
+    }
+}
+
+void BeamBot::keepBest(uint16_t width)
+{
+    const size_t kept{std::min<size_t>(width, merged.size())};
+    std::partial_sort(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(kept), merged.end(),
+                      [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+
+    nextBeam.clear();
+    for (size_t i = 0; i < kept; i++)
+    {
+        const Candidate &candidate{merged[i]};
+        Node &node{nextBeam.emplace_back(Node{beam[candidate.parent].gameManager, candidate.reward, candidate.queueIndex, candidate.root})};
+        if (candidate.held != PieceType::NONE)
+        {
+            node.gameManager.setHeldTetromino(Tetromino{candidate.held});
+            node.gameManager.setHasHeld(true);
+        }
+        node.gameManager.handleCollision(candidate.piece);
+        node.gameManager.clearRows();
+    }
+    beam.swap(nextBeam);
+}
@@ -0,0 +1,11 @@
+#include "board.hpp"
+
+// The game's board and the variants other rule sets need, each compiled with its own row type
+template struct BasicBoard<GRID_WIDTH, GRID_HEIGHT, GRID_BUFFER>;
+template struct BasicBoard<10, 40, 20>;
+template struct BasicBoard<4, 20, 20>;
+template struct BasicBoard<20, 20, 20>;
+
+static_assert(std::is_same_v<BasicBoard<4, 20, 20>::Row, uint16_t> && BasicBoard<4, 20, 20>::FULL_ROW == 0xF);
+static_assert(std::is_same_v<BasicBoard<20, 20, 20>::Row, uint32_t> && BasicBoard<20, 20, 20>::FULL_ROW == 0xFFFFF);
+static_assert(Board::FULL_ROW == (1u << GRID_WIDTH) - 1);
@@ -0,0 +1,97 @@
+#include "board_features.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstdlib>
+
+#if defined(TETRIS_HAS_AVX2_KERNEL) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// Walls on both sides of a row count as filled cells when counting transitions
+constexpr uint32_t TRANSITION_WALLS{1u | (1u << (GRID_WIDTH + 1))};
+constexpr uint32_t TRANSITION_PAIRS{(1u << (GRID_WIDTH + 1)) - 1};
+
+BotFeatures boardFeatures(const Board &board, uint8_t linesCleared)
+{
+    int aggregateHeight{};
+    int bumpiness{};
+    int wellDepth{};
+    for (int j = 0; j < GRID_WIDTH; j++)
+    {
+        const int height{board.columnHeights[j]};
+        aggregateHeight += height;
+        if (j + 1 < GRID_WIDTH)
+            bumpiness += std::abs(height - board.columnHeights[j + 1]);
+
+        const int left{j > 0 ? board.columnHeights[j - 1] : GRID_HEIGHT};
+        const int right{j + 1 < GRID_WIDTH ? board.columnHeights[j + 1] : GRID_HEIGHT};
+        wellDepth += std::max(0, std::min(left, right) - height);
+    }
+
+    // Every cell under a column's top is either filled or a hole. Empty hidden rows are
+    // left out, so a stack inside the visible field scores the same as without a buffer.
+    int filled{};
+    int rowTransitions{};
+    for (int i = firstFeatureRow(board); i < Board::TOTAL_HEIGHT; i++)
+    {
+        const Board::Row row{board.rows[i]};
+        const uint32_t walled{(uint32_t{row} << 1) | TRANSITION_WALLS};
+        filled += static_cast<int>(std::bitset<GRID_WIDTH>(row).count());
+        rowTransitions += static_cast<int>(std::bitset<GRID_WIDTH + 1>((walled ^ (walled >> 1)) & TRANSITION_PAIRS).count());
+    }
+
+    BotFeatures features{};
+    features[FEATURE_AGGREGATE_HEIGHT] = static_cast<float>(aggregateHeight);
+    features[FEATURE_HOLES] = static_cast<float>(aggregateHeight - filled);
+    features[FEATURE_BUMPINESS] = static_cast<float>(bumpiness);
+    features[FEATURE_LINES_CLEARED] = static_cast<float>(linesCleared);
+    features[FEATURE_ROW_TRANSITIONS] = static_cast<float>(rowTransitions);
+    features[FEATURE_WELL_DEPTH] = static_cast<float>(wellDepth);
+    return features;
+}
+
+void boardFeaturesScalar(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features)
+{
+    for (size_t i = 0; i < count; i++)
+        features[i] = boardFeatures(boards[i], linesCleared[i]);
+}
+
+// The OS must save the YMM registers as well, not only the CPU support AVX2
+static bool cpuSupportsAvx2()
+{
+#if !defined(TETRIS_HAS_AVX2_KERNEL)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool boardFeaturesUseAvx2()
+{
+    static const bool useAvx2{cpuSupportsAvx2()};
+    return useAvx2;
+}
+
+void boardFeatures(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features)
+{
+#ifdef TETRIS_HAS_AVX2_KERNEL
+    if (boardFeaturesUseAvx2())
+    {
+        boardFeaturesAvx2(boards, linesCleared, count, features);
+        return;
+    }
+#endif
+    boardFeaturesScalar(boards, linesCleared, count, features);
+}
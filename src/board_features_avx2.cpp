@@ -0,0 +1,121 @@
+#include "board_features.hpp"
+#include <algorithm>
+#include <immintrin.h>
+
+// Only the kernel's own functions are compiled for AVX2, never the inline code and static
+// initializers this file shares with the rest of the program, and they are only called
+// after the runtime CPU check. MSVC builds the whole file with /arch:AVX2 instead.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+AVX2_TARGET static __m256i popcount(__m256i values)
+{
+    const __m256i lookup{_mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4)};
+    const __m256i lowNibbles{_mm256_set1_epi8(0x0F)};
+    const __m256i low{_mm256_and_si256(values, lowNibbles)};
+    const __m256i high{_mm256_and_si256(_mm256_srli_epi16(values, 4), lowNibbles)};
+    const __m256i byteCounts{_mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high))};
+    // Sum the two byte counts of every 16-bit lane
+    return _mm256_maddubs_epi16(byteCounts, _mm256_set1_epi8(1));
+}
+
+static_assert(std::is_same_v<Board::Row, uint16_t>, "The kernel keeps one row per 16-bit lane");
+
+// Lane b of every vector belongs to board b of the batch; missing boards stay empty.
+// Rows above the highest first feature row of the batch are skipped, and a lane whose
+// own first row is lower has the transitions of its extra empty rows taken off again.
+AVX2_TARGET static void storeLanes(std::array<int16_t, FEATURE_BATCH_SIZE> &lanes, __m256i values)
+{
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes.data()), values);
+}
+
+AVX2_TARGET static void evaluateBatch(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features)
+{
+    alignas(32) std::array<std::array<uint16_t, FEATURE_BATCH_SIZE>, Board::TOTAL_HEIGHT> rows{};
+    alignas(32) std::array<uint16_t, FEATURE_BATCH_SIZE> lines{};
+    alignas(32) std::array<uint16_t, FEATURE_BATCH_SIZE> extraRows{};
+    std::array<int, FEATURE_BATCH_SIZE> firstRows{};
+    int batchFirstRow{Board::BUFFER};
+    for (size_t b = 0; b < count; b++)
+    {
+        firstRows[b] = firstFeatureRow(boards[b]);
+        batchFirstRow = std::min(batchFirstRow, firstRows[b]);
+    }
+    for (size_t b = 0; b < count; b++)
+    {
+        for (int i = batchFirstRow; i < Board::TOTAL_HEIGHT; i++)
+            rows[i][b] = boards[b].rows[i];
+        lines[b] = linesCleared[b];
+        extraRows[b] = static_cast<uint16_t>(firstRows[b] - batchFirstRow);
+    }
+
+    const __m256i one{_mm256_set1_epi16(1)};
+    const __m256i walls{_mm256_set1_epi16(1 | (1 << (GRID_WIDTH + 1)))};
+    const __m256i pairs{_mm256_set1_epi16((1 << (GRID_WIDTH + 1)) - 1)};
+
+    // Walking down from the top, a column's height grows by one for every row at or below its first filled cell
+    __m256i heights[GRID_WIDTH];
+    for (__m256i &height : heights)
+        height = _mm256_setzero_si256();
+    __m256i covered{_mm256_setzero_si256()};
+    __m256i filled{_mm256_setzero_si256()};
+    __m256i rowTransitions{_mm256_setzero_si256()};
+    for (int i = batchFirstRow; i < Board::TOTAL_HEIGHT; i++)
+    {
+        const __m256i row{_mm256_load_si256(reinterpret_cast<const __m256i *>(rows[i].data()))};
+        covered = _mm256_or_si256(covered, row);
+        filled = _mm256_add_epi16(filled, popcount(row));
+
+        const __m256i walled{_mm256_or_si256(_mm256_slli_epi16(row, 1), walls)};
+        const __m256i transitions{_mm256_and_si256(_mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1)), pairs)};
+        rowTransitions = _mm256_add_epi16(rowTransitions, popcount(transitions));
+
+        for (int j = 0; j < GRID_WIDTH; j++)
+            heights[j] = _mm256_add_epi16(heights[j], _mm256_and_si256(_mm256_srli_epi16(covered, j), one));
+    }
+
+    const __m256i wallHeight{_mm256_set1_epi16(GRID_HEIGHT)};
+    __m256i aggregateHeight{_mm256_setzero_si256()};
+    __m256i bumpiness{_mm256_setzero_si256()};
+    __m256i wellDepth{_mm256_setzero_si256()};
+    for (int j = 0; j < GRID_WIDTH; j++)
+    {
+        aggregateHeight = _mm256_add_epi16(aggregateHeight, heights[j]);
+        if (j + 1 < GRID_WIDTH)
+            bumpiness = _mm256_add_epi16(bumpiness, _mm256_abs_epi16(_mm256_sub_epi16(heights[j], heights[j + 1])));
+
+        const __m256i left{j > 0 ? heights[j - 1] : wallHeight};
+        const __m256i right{j + 1 < GRID_WIDTH ? heights[j + 1] : wallHeight};
+        const __m256i depth{_mm256_sub_epi16(_mm256_min_epi16(left, right), heights[j])};
+        wellDepth = _mm256_add_epi16(wellDepth, _mm256_max_epi16(depth, _mm256_setzero_si256()));
+    }
+
+    alignas(32) std::array<std::array<int16_t, FEATURE_BATCH_SIZE>, BOT_FEATURE_COUNT> lanes;
+    storeLanes(lanes[FEATURE_AGGREGATE_HEIGHT], aggregateHeight);
+    storeLanes(lanes[FEATURE_HOLES], _mm256_sub_epi16(aggregateHeight, filled));
+    storeLanes(lanes[FEATURE_BUMPINESS], bumpiness);
+    storeLanes(lanes[FEATURE_LINES_CLEARED], _mm256_load_si256(reinterpret_cast<const __m256i *>(lines.data())));
+    // An empty row has one transition against each wall
+    const __m256i extraTransitions{_mm256_slli_epi16(_mm256_load_si256(reinterpret_cast<const __m256i *>(extraRows.data())), 1)};
+    storeLanes(lanes[FEATURE_ROW_TRANSITIONS], _mm256_sub_epi16(rowTransitions, extraTransitions));
+    storeLanes(lanes[FEATURE_WELL_DEPTH], wellDepth);
+
+    for (size_t b = 0; b < count; b++)
+    {
+        for (uint8_t f = 0; f < BOT_FEATURE_COUNT; f++)
+            features[b][f] = static_cast<float>(lanes[f][b]);
+    }
+}
+
+AVX2_TARGET void boardFeaturesAvx2(const Board *boards, const uint8_t *linesCleared, size_t count, BotFeatures *features)
+{
+    for (size_t first = 0; first < count; first += FEATURE_BATCH_SIZE)
+    {
+        const size_t batch{std::min(FEATURE_BATCH_SIZE, count - first)};
+        evaluateBatch(boards + first, linesCleared + first, batch, features + first);
+    }
+}
@@ -0,0 +1,52 @@
+#include "bot.hpp"
+
+std::optional<Placement> Bot::choose(const Simulation &simulation)
+{
+    generator.generate(simulation, placements);
+    const Board &board{simulation.getGameManager().board};
+
+    candidates.assign(placements.size(), board);
+    linesCleared.resize(placements.size());
+    features.resize(placements.size());
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        const Tetromino &tetromino{placements[i].tetromino};
+        candidates[i].place(tetromino.mask(), tetromino.pos.x, tetromino.pos.y, tetromino.color());
+        linesCleared[i] = candidates[i].clearFullRows();
+    }
+    boardFeatures(candidates.data(), linesCleared.data(), candidates.size(), features.data());
+
+    std::optional<Placement> best;
+    float bestScore{};
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        float score{};
+        for (uint8_t f = 0; f < BOT_FEATURE_COUNT; f++)
+            score += weights[f] * features[i][f];
+        if (!best || score > bestScore)
+        {
+            best = placements[i];
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+void Bot::plan(const Simulation &simulation, std::vector<Action> &actions)
+{
+    actions.clear();
+    if (const std::optional<Placement> placement{choose(simulation)})
+        generator.path(*placement, actions);
+}
+
+uint8_t Bot::playPiece(Simulation &simulation)
+{
+    plan(simulation, path);
+    if (path.empty())
+        return simulation.apply(Action::HARD_DROP);
+
+    uint8_t events{EVENT_NONE};
+    for (Action action : path)
+        events |= simulation.apply(action);
+    return events;
+}
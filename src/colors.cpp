@@ -1,4 +1,4 @@
-#include "common.hpp"
+#include "render.hpp"
 
 sf::Color enumToColor(Color choice)
 {
@@ -24,6 +24,8 @@ sf::Color enumToColor(Color choice)
         return sf::Color(10, 20, 60);
     case TRANSPARENT:
         return sf::Color(255, 255, 255, 64);
+    case GARBAGE:
+        return sf::Color(110, 110, 120);
     default:
         return sf::Color::Black;
     }
@@ -1,15 +1,58 @@
 #include "game.hpp"
+#include <chrono>
+#include <iostream>
 
-Game::Game() : rotateSound(rotate), hardDropSound(hardDrop), holdSound(hold), invalidSound(invalid)
+Game::Game(const GameOptions &options)
 {
+    if (options.previewCount < 1 || options.previewCount > PREVIEW_MAX)
+    {
+        throw std::runtime_error("Preview count must be between 1 and " + std::to_string(PREVIEW_MAX) + ".\n");
+    }
+    renderer.setPreviewCount(options.previewCount);
+
+#ifdef TETRIS_EMBED_ASSETS
+    assets.emplace(EMBEDDED_ASSETS, EMBEDDED_ASSETS_SIZE);
+#else
+    assetFile.emplace(options.assetPath);
+    assets.emplace(assetFile->data(), assetFile->size());
+#endif
+
+    if (options.netplay)
+    {
+        NetplayOptions netplayOptions{*options.netplay};
+        netplayOptions.seed = std::random_device{}();
+        netplay.emplace(netplayOptions);
+    }
+    else if (options.royalePlayers > 0)
+    {
+        royalePlayers = options.royalePlayers;
+        royalePool.emplace();
+        startRoyale();
+    }
+    else if (!options.replayPath.empty())
+    {
+        replayFile.emplace(options.replayPath);
+        replayReader.emplace(replayFile->data(), replayFile->size());
+        const ReplayHeader &header{replayReader->getHeader()};
+        simulation = Simulation(header.seed, header.mode);
+        ReplayEvent event;
+        if (replayReader->next(event))
+            pendingReplayEvent = event;
+    }
+
     window = sf::RenderWindow(sf::VideoMode({DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT}), static_cast<std::string>(WINDOW_TITLE), sf::State::Windowed);
     window.setFramerateLimit(FRAME_RATE);
+    window.setVerticalSyncEnabled(VERTICAL_SYNC);
+    window.setKeyRepeatEnabled(false);
 
     fixedView.setSize({TARGET_WIDTH, TARGET_HEIGHT});
     fixedView.setCenter({TARGET_WIDTH / 2.0f, TARGET_HEIGHT / 2.0f});
 
     applyView();
-    loadAssets();
+    startLoading();
+    Tracer::instance().setEnabled(true);
+    if (options.autoplay)
+        toggleAutoplay();
 }
 void Game::applyView()
 {
@@ -48,135 +91,498 @@ void Game::applyView()
     window.setView(fixedView);
 }
 
-void Game::loadAssets()
+void Game::loadAsync(bool required, std::function<void()> work, std::function<void()> install)
+{
+    pendingAssets.push_back({std::async(std::launch::async, std::move(work)), std::move(install), required});
+}
+
+void Game::startLoading()
+{
+    // The font is the only asset the first frame of gameplay cannot do without
+    loadAsync(true, [this]
+         {
+             const AssetEntry &font{assets->get("fonts/Roboto-VariableFont_wdth,wght.ttf")};
+             if (!roboto.openFromMemory(font.data, font.size))
+             {
+                 throw std::runtime_error("Failed to load font.\n");
+             } },
+         [this]
+         { renderer.buildStaticLayer(); });
+    loadAsync(false, [this]
+         {
+             const AssetEntry &image{assets->get("icon/icon.png")};
+             if (!icon.loadFromMemory(image.data, image.size))
+             {
+                 throw std::runtime_error("Failed to load icon.\n");
+             } },
+         [this]
+         {
+             window.setIcon(icon);
+             iconLoaded = true;
+         });
+    loadAsync(false, [this]
+         {
+             const AssetEntry &music{assets->get("audio/theme.mp3")};
+             if (!themeMusic.openFromMemory(music.data, music.size))
+             {
+                 throw std::runtime_error("Failed to load theme music.\n");
+             } },
+         [this]
+         {
+             themeMusic.setLooping(true);
+             themeMusic.setPlayingOffset(sf::seconds(1.0f));
+             themeMusic.play();
+             musicLoaded = true;
+         });
+    loadSound(SOUND_ROTATE, "audio/rotate.wav", "rotate");
+    loadSound(SOUND_HARD_DROP, "audio/hard-drop.wav", "hard-drop");
+    loadSound(SOUND_HOLD, "audio/hold.wav", "hold");
+    loadSound(SOUND_INVALID, "audio/invalid.mp3", "invalid");
+    assetCount = pendingAssets.size();
+}
+
+// Sound buffers decode the whole file to PCM here, so playing one never touches the decoder
+void Game::loadSound(SoundId id, const std::string &path, const std::string &name)
+{
+    loadAsync(false, [this, id, path, name]
+              {
+                  const AssetEntry &sound{assets->get(path)};
+                  if (!sounds.getBuffer(id).loadFromMemory(sound.data, sound.size))
+                  {
+                      throw std::runtime_error("Failed to load " + name + " sound.\n");
+                  } },
+              [this, id]
+              { sounds.markLoaded(id); });
+}
+
+// Installs every asset whose load has finished. A failed required load rethrows its error
+// here; any other is logged and its effect stays silent, since the game may be in progress.
+void Game::pollAssets()
 {
-    if (!icon.loadFromFile("icon/icon.png"))
+    for (auto it = pendingAssets.begin(); it != pendingAssets.end();)
     {
-        throw std::runtime_error("Failed to load icon.\n");
+        if (it->loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        try
+        {
+            it->loading.get();
+            it->install();
+        }
+        catch (const std::exception &e)
+        {
+            if (it->required)
+                throw;
+            std::cerr << e.what();
+        }
+        it = pendingAssets.erase(it);
     }
-    else if (!roboto.openFromFile("fonts/Roboto-VariableFont_wdth,wght.ttf"))
+}
+
+bool Game::requiredAssetsReady() const
+{
+    return std::none_of(pendingAssets.begin(), pendingAssets.end(), [](const PendingAsset &asset)
+                        { return asset.required; });
+}
+
+void Game::run()
+{
+
+    // The window is already up; show progress until gameplay can be drawn
+    while (window.isOpen() && !requiredAssetsReady())
     {
-        throw std::runtime_error("Failed to load font.\n");
+        handleInputs();
+        pollAssets();
+        window.clear(BACKGROUND_COLOR);
+        renderer.drawLoadingScreen(1.0f - static_cast<float>(pendingAssets.size()) / assetCount);
+        window.display();
+    }
+    pendingInputs.clear();
+
+    const sf::Time tickTime{sf::seconds(1.0f / TICK_RATE)};
+    const sf::Time maxFrameTime{sf::seconds(MAX_FRAME_TIME)};
+    const sf::Time frameStatsInterval{sf::seconds(0.25f)};
+    frameStart = gameClock.getElapsedTime();
+    sf::Time accumulator{sf::Time::Zero};
+    sf::Time frameStatsElapsed{sf::Time::Zero};
+    Tetromino previousTetromino{shownSimulation().getCurrentTetromino()};
+
+    while (window.isOpen())
+    {
+        TRACE_SCOPE("Game::frame");
+        handleInputs();
+        pollAssets();
+
+        const sf::Time now{gameClock.getElapsedTime()};
+        const sf::Time frameTime{now - frameStart};
+        frameStart = now;
+        frameTimes.add(frameTime.asSeconds() * 1000.0f);
+        frameStatsElapsed += frameTime;
+        if (frameStatsElapsed >= frameStatsInterval)
+        {
+            frameP50 = frameTimes.percentile(0.5f);
+            frameP99 = frameTimes.percentile(0.99f);
+            frameStatsElapsed = sf::Time::Zero;
+        }
+
+        // The ticks run this frame cover the wall-clock span from the last frame up to now,
+        // the span the keys just polled were pressed in, so the first tick takes them all
+        accumulator += std::min(frameTime, maxFrameTime);
+        sf::Time tickEnd{now - accumulator + tickTime};
+        uint32_t ticksRun{};
+        while (accumulator >= tickTime)
+        {
+            previousTetromino = shownSimulation().getCurrentTetromino();
+            if (practiceMode && !rewindHeld)
+                rewindBuffer.push(simulation.snapshot());
+            deliverInputs(tickEnd);
+            stepSimulation();
+            accumulator -= tickTime;
+            tickEnd += tickTime;
+            ticksRun++;
+        }
+        if (royale)
+            stepRoyale(ticksRun);
+
+        // Slide the active piece between its last two tick positions when gravity moved it
+        const Simulation &shown{shownSimulation()};
+        const GameManager &gameManager{shown.getGameManager()};
+        const Tetromino &currentTetromino{shown.getCurrentTetromino()};
+        float fallOffset{0.0f};
+        if (previousTetromino.type == currentTetromino.type &&
+            previousTetromino.rotationIndex == currentTetromino.rotationIndex &&
+            previousTetromino.pos.x == currentTetromino.pos.x &&
+            previousTetromino.pos.y + 1 == currentTetromino.pos.y)
+        {
+            fallOffset = accumulator / tickTime - 1.0f;
+        }
+
+        window.clear(BACKGROUND_COLOR);
+        renderer.drawStaticLayer();
+        renderer.drawGrid(gameManager.board);
+        renderer.drawTetromino(shown.getGhostTetromino(), true);
+        renderer.drawTetromino(currentTetromino, false, fallOffset);
+        renderer.drawNextTetromino(shown.getQueue());
+        renderer.drawHeldTetromino(gameManager.getHeldTetromino());
+        renderer.drawPieces();
+        renderer.drawStats(gameManager.getScore(), gameManager.getLevel(), gameManager.getStatsRevision());
+        if (showFrameStats)
+            renderer.drawFrameStats(frameP50, frameP99);
+        if (practiceMode)
+            renderer.drawPracticeMode(isRewinding());
+        if (autoplay)
+            renderer.drawAutoplay(autoplayWidth, autoplayDepth);
+        if (netplay)
+            drawVersus();
+        if (royale)
+            drawRoyale();
+        {
+            TRACE_SCOPE("window.display");
+            window.display();
+        }
     }
-    else if (!themeMusic.openFromFile("audio/theme.mp3"))
+
+    // A royale's garbage comes from outside the replay, so it could not be played back
+    if (!replayReader && !practiced && !netplay && !royale)
     {
-        throw std::runtime_error("Failed to load theme music.\n");
+        const auto now{std::chrono::system_clock::now().time_since_epoch()};
+        const auto stamp{std::chrono::duration_cast<std::chrono::seconds>(now).count()};
+        replayWriter.save("replays/replay-" + std::to_string(stamp) + ".trpl", simulation);
     }
-    else if (!rotate.loadFromFile("audio/rotate.wav"))
+}
+
+void Game::stepSimulation()
+{
+    if (netplay)
     {
-        throw std::runtime_error("Failed to load rotate sound.\n");
+        netplay->poll();
+        if (const std::optional<uint8_t> events{netplay->advance(heldButtons)})
+            handleEvents(*events);
     }
-    else if (!hardDrop.loadFromFile("audio/hard-drop.wav"))
+    else if (isRewinding())
     {
-        throw std::runtime_error("Failed to load hard-drop sound.\n");
+        GameState state;
+        if (rewindBuffer.pop(state))
+            simulation.restore(state);
     }
-    else if (!hold.loadFromFile("audio/hold.wav"))
+    else if (!replayReader)
     {
-        throw std::runtime_error("Failed to load hold sound.\n");
+        if (autoplay)
+        {
+            playAutoplay();
+        }
+        else
+        {
+            inputHandler.tick(simulation.gravityDelayTicks(), inputActions);
+            for (Action action : inputActions)
+                applyAction(action);
+            inputActions.clear();
+        }
+        handleEvents(simulation.tick());
+        if (autoplay)
+            searchAutoplay();
+        if (royale)
+            royaleAttack += simulation.takeOutgoingGarbage();
     }
-    else if (!invalid.loadFromFile("audio/invalid.mp3"))
+    else if (simulation.getTickCount() < replayReader->getHeader().finalTick)
     {
-        throw std::runtime_error("Failed to load invalid sound.\n");
+        advanceReplay();
+        handleEvents(simulation.tick());
+        advanceReplay();
     }
+}
 
-    window.setIcon(icon);
-    themeMusic.setLooping(true);
-    themeMusic.setPlayingOffset(sf::seconds(1.0f));
-    themeMusic.play();
-    rotateSound.setVolume(40.0f);
-    hardDropSound.setVolume(50.0f);
-    holdSound.setVolume(50.0f);
-    invalidSound.setVolume(25.0f);
+void Game::applyAction(Action action)
+{
+    if (replayReader || isRewinding())
+        return;
+    replayWriter.record(simulation.getTickCount(), action);
+    handleEvents(simulation.apply(action));
 }
 
-void Game::run()
+void Game::queueInput(sf::Keyboard::Scancode scancode, bool pressed)
 {
-    sf::Text textScore(roboto);
-    sf::Text textLevel(roboto);
+    std::optional<Action> button;
+    switch (scancode)
+    {
+    case sf::Keyboard::Scancode::Up:
+    case sf::Keyboard::Scancode::W:
+        button = Action::ROTATE_CCW;
+        break;
+    case sf::Keyboard::Scancode::Z:
+        button = Action::ROTATE_CW;
+        break;
+    case sf::Keyboard::Scancode::Right:
+    case sf::Keyboard::Scancode::D:
+        button = Action::MOVE_RIGHT;
+        break;
+    case sf::Keyboard::Scancode::Down:
+    case sf::Keyboard::Scancode::S:
+        button = Action::SOFT_DROP;
+        break;
+    case sf::Keyboard::Scancode::Left:
+    case sf::Keyboard::Scancode::A:
+        button = Action::MOVE_LEFT;
+        break;
+    case sf::Keyboard::Scancode::Space:
+        button = Action::HARD_DROP;
+        break;
+    case sf::Keyboard::Scancode::R:
+        button = Action::RESET;
+        break;
+    case sf::Keyboard::Scancode::C:
+        button = Action::HOLD;
+        break;
+    default:
+        break;
+    }
+    if (button && !replayReader)
+        pendingInputs.push_back({frameStart, *button, pressed});
+}
 
-    textScore.setString("Score: " + std::to_string(gameManager.getScore()));
-    textScore.setCharacterSize(96);
+void Game::deliverInputs(sf::Time until)
+{
+    while (!pendingInputs.empty() && pendingInputs.front().time < until)
+    {
+        const TimedInput &input{pendingInputs.front()};
+        if (netplay)
+        {
+            const uint8_t bit{static_cast<uint8_t>(1u << static_cast<uint8_t>(input.button))};
+            heldButtons = input.pressed ? heldButtons | bit : heldButtons & ~bit;
+        }
+        else if (input.pressed)
+            inputHandler.press(input.button, inputActions);
+        else
+            inputHandler.release(input.button);
+        pendingInputs.pop_front();
+    }
+    if (!autoplay)
+    {
+        for (Action action : inputActions)
+            applyAction(action);
+    }
+    inputActions.clear();
+}
 
-    textLevel.setString("Level " + std::to_string(gameManager.getLevel()));
-    textLevel.setCharacterSize(96);
+// Applies every recorded action that belongs to the tick just simulated
+void Game::advanceReplay()
+{
+    while (pendingReplayEvent && pendingReplayEvent->tick <= simulation.getTickCount())
+    {
+        handleEvents(simulation.apply(pendingReplayEvent->action));
+        ReplayEvent event;
+        if (replayReader->next(event))
+            pendingReplayEvent = event;
+        else
+            pendingReplayEvent.reset();
+    }
+}
 
-    gameManager.initializeTetrominoes();
-    bag = gameManager.generateBag();
-    std::optional<Tetromino> tempTetromino{gameManager.newTetromino(*bag.begin())};
-    if (!tempTetromino)
+void Game::handleEvents(uint8_t events)
+{
+    inputHandler.handleEvents(events);
+    if (events & EVENT_ROTATED)
+        sounds.play(SOUND_ROTATE);
+    if (events & EVENT_HARD_DROPPED)
+        sounds.play(SOUND_HARD_DROP);
+    if (events & EVENT_HELD)
+        sounds.play(SOUND_HOLD);
+    if (events & EVENT_HOLD_FAILED)
+        sounds.play(SOUND_INVALID);
+    if ((events & (EVENT_TOPPED_OUT | EVENT_RESET)) && musicLoaded)
+        themeMusic.setPlayingOffset(sf::seconds(1.0f));
+    if (royale)
     {
-        throw std::runtime_error("Failed to generate initial Tetromino.");
+        royaleToppedOut |= (events & EVENT_TOPPED_OUT) != 0;
+        royaleRestart |= (events & EVENT_RESET) != 0;
     }
-    currentTetromino = *tempTetromino;
-    bag.erase(bag.begin());
+}
 
-    while (window.isOpen())
+void Game::togglePracticeMode()
+{
+    if (replayReader || netplay || royale)
+        return;
+    practiceMode = !practiceMode;
+    practiced = true;
+    rewindBuffer.clear();
+}
+
+void Game::toggleAutoplay()
+{
+    if (replayReader || netplay)
+        return;
+    autoplay = !autoplay;
+    autoplayPlan.reset();
+    inputHandler.releaseAll();
+}
+
+// What a plan depends on besides the piece's position: the board, the hold and the queue
+uint64_t Game::autoplayHash() const
+{
+    return simulation.getGameManager().positionHash(simulation.getCurrentTetromino(), simulation.getQueue(), PIECE_QUEUE_LENGTH) ^ simulation.getPiecesPlaced();
+}
+
+// Plays the finished plan, if any, before the tick; never waits for a search
+void Game::playAutoplay()
+{
+    if (autoplaySearch.valid() && autoplaySearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        autoplayPlan = autoplaySearch.get();
+    if (autoplayPlan && (simulation.getCurrentTetromino() != autoplayPiece || autoplayHash() != autoplayPosition))
+        autoplayPlan.reset();
+    if (!autoplayPlan || simulation.getTickCount() < autoplayNextTick)
+        return;
+
+    autoplayWidth = autoplayPlan->width;
+    autoplayDepth = autoplayPlan->depth;
+    if (autoplayPlan->actions.empty())
+        autoplayPlan->actions.push_back(Action::HARD_DROP);
+    for (Action action : autoplayPlan->actions)
+        applyAction(action);
+    autoplayPlan.reset();
+    autoplayNextTick = simulation.getTickCount() + static_cast<uint64_t>(AUTOPLAY_PIECE_DELAY * TICK_RATE);
+}
+
+// Starts a search from the position after the tick, so nothing moves the piece before the next one
+void Game::searchAutoplay()
+{
+    if (autoplaySearch.valid() || autoplayPlan)
+        return;
+    autoplayPiece = simulation.getCurrentTetromino();
+    autoplayPosition = autoplayHash();
+    autoplaySearch = std::async(std::launch::async, [this, position = simulation] { return autoplayBot.plan(position); });
+}
+
+const Simulation &Game::shownSimulation() const
+{
+    if (netplay && netplay->isStarted())
     {
-        sf::Time delayElapsed{delayClock.getElapsedTime()};
-        sf::Time lockDelayElapsed = lockDelayClock.getElapsedTime();
-        uint8_t delayModifier = gameManager.getLevel();
-        if (delayModifier > 9)
-            delayModifier = 9;
-        wasGrounded = grounded;
-        grounded = gameManager.isGrounded(currentTetromino);
-        if (grounded && lockCounter >= LOCK_LIMIT)
-        {
-            gameManager.handleCollision(currentTetromino);
-            gameManager.handleWreck(currentTetromino, bag);
-            lockDelayClock.restart();
-            lockCounter = 0;
-        }
-        if (delayElapsed.asSeconds() > DELAY - ((DELAY * (delayModifier - 1)) / 15))
-        {
+        const RollbackSession &session{netplay->getSession()};
+        return session.getMatch().getPlayer(session.getLocalPlayer());
+    }
+    return simulation;
+}
 
-            if (!grounded)
-            {
-                currentTetromino.pos.y++;
-                lockDelayClock.restart();
-            }
-            else
-            {
-                lockCounter++;
-                if (lockDelayElapsed.asSeconds() >= LOCK_DELAY - ((LOCK_DELAY * (delayModifier - 1)) / 10))
-                {
-                    gameManager.handleCollision(currentTetromino);
-                    gameManager.handleWreck(currentTetromino, bag);
-                    lockDelayClock.restart();
-                    lockCounter = 0;
-                }
-            }
-            delayClock.restart();
-        }
-        handleInputs();
-        Tetromino ghostTetromino{currentTetromino};
-        ghostTetromino.color = TRANSPARENT;
-        while (gameManager.isValidPosition(ghostTetromino))
-        {
-            ghostTetromino.pos.y++;
-        }
-        ghostTetromino.pos.y--;
-        if (bag.empty())
-            bag = gameManager.generateBag();
-        gameManager.clearRows();
-
-        window.clear(sf::Color(0, 0, 28));
-        renderer.drawGrid(gameManager.screenState);
-        renderer.drawTetromino(ghostTetromino);
-        renderer.drawTetromino(currentTetromino);
-        renderer.drawNextTetromino(bag[0]);
-        renderer.drawHeldTetromino(gameManager.getHeldTetromino());
-        const float textLevelX{renderer.getStartX() - GRID_WIDTH * CELL_SIZE};
-        const float textLevelY{renderer.getStartY()};
-        renderer.drawText(textLevel, "Level " + std::to_string(gameManager.getLevel()), textLevelX, textLevelY);
-        const float textScoreX{renderer.getStartX() + GRID_WIDTH * CELL_SIZE + CELL_SIZE * 2};
-        const float textScoreY{renderer.getStartY()};
-        renderer.drawText(textScore, "Score: " + std::to_string(gameManager.getScore()), textScoreX, textScoreY);
-        window.display();
+void Game::drawVersus()
+{
+    if (!netplay->isStarted())
+    {
+        renderer.drawMessage("Waiting for opponent");
+        return;
+    }
+    const RollbackSession &session{netplay->getSession()};
+    const VersusMatch &match{session.getMatch()};
+    const Simulation &opponent{match.getPlayer(1 - session.getLocalPlayer())};
+    renderer.drawOpponent(opponent.getGameManager().board, opponent.getGarbagePending());
+    renderer.drawGarbageMeter(shownSimulation().getGarbagePending());
+
+    const VersusResult result{match.getResult()};
+    const VersusResult won{session.getLocalPlayer() == 0 ? VersusResult::FIRST_WON : VersusResult::SECOND_WON};
+    if (netplay->isDisconnected())
+        renderer.drawMessage("Connection lost");
+    else if (result == VersusResult::DRAW)
+        renderer.drawMessage("Draw");
+    else if (result != VersusResult::PLAYING)
+        renderer.drawMessage(result == won ? "You win" : "You lose");
+}
+
+// A new match on a new piece sequence, shared by the local player and every bot
+void Game::startRoyale()
+{
+    const uint64_t seed{std::random_device{}()};
+    royale.reset();
+    simulation = Simulation(seed);
+    royale.emplace(royalePlayers, seed, *royalePool);
+    royaleAttack = 0;
+    royaleToppedOut = false;
+    royaleRestart = false;
+}
+
+void Game::stepRoyale(uint32_t ticks)
+{
+    TRACE_SCOPE("Game::stepRoyale");
+    if (royaleRestart)
+        startRoyale();
+    royale->finish(royaleAttack, royaleToppedOut);
+    royaleAttack = 0;
+    royaleToppedOut = false;
+    for (const auto &[lines, hole] : royale->getHumanGarbage())
+        simulation.receiveGarbage(lines, hole);
+    royale->start(ticks);
+}
+
+void Game::drawRoyale()
+{
+    renderer.drawMiniBoards(royale->getBotBoards(), royale->getBotEliminated());
+    renderer.drawGarbageMeter(simulation.getGarbagePending());
+    renderer.drawSurvivors(royale->getSurvivors(), royale->getPlayerCount());
+
+    const uint8_t placement{royale->getPlacement(0)};
+    if (placement == 1)
+        renderer.drawMessage("You win");
+    else if (placement > 1)
+        renderer.drawMessage("Place " + std::to_string(placement) + "  R to restart");
+}
+
+// Writes the recent frame phases as Chrome trace JSON; a failed dump is logged without ending the game
+void Game::dumpTrace()
+{
+    const auto now{std::chrono::system_clock::now().time_since_epoch()};
+    const auto stamp{std::chrono::duration_cast<std::chrono::milliseconds>(now).count()};
+    try
+    {
+        Tracer::instance().writeChromeTrace("traces/trace-" + std::to_string(stamp) + ".json");
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what();
     }
 }
 
 void Game::handleInputs()
 {
+    TRACE_SCOPE("Game::handleInputs");
     while (const std::optional event{window.pollEvent()})
     {
         if (event->is<sf::Event::Closed>())
@@ -208,150 +614,50 @@ void Game::handleInputs()
                 {
                     window.create(sf::VideoMode({currentWindowWidth, currentWindowHeight}), static_cast<std::string>(WINDOW_TITLE), sf::State::Windowed);
                     window.setPosition(windowPos);
-                    window.setIcon(icon);
+                    if (iconLoaded)
+                        window.setIcon(icon);
                 }
                 window.setFramerateLimit(FRAME_RATE);
+                window.setVerticalSyncEnabled(VERTICAL_SYNC);
+                window.setKeyRepeatEnabled(false);
                 applyView();
                 break;
             }
 
-            case sf::Keyboard::Scancode::Up:
-            case sf::Keyboard::Scancode::W:
-            {
-                Tetromino rotatedCCW{currentTetromino.rotatedCCW()};
-                if (gameManager.tryRotate(currentTetromino, rotatedCCW))
-                {
-                    lockDelayClock.restart();
-                    if (gameManager.isGrounded(currentTetromino))
-                        lockCounter++;
-                    rotateSound.play();
-                }
-                break;
-            }
-            case sf::Keyboard::Scancode::Z:
-            {
-                Tetromino rotatedCW{currentTetromino.rotatedCW()};
-                if (gameManager.tryRotate(currentTetromino, rotatedCW))
-                {
-                    lockDelayClock.restart();
-                    if (gameManager.isGrounded(currentTetromino))
-                        lockCounter++;
-                    rotateSound.play();
-                }
+            case sf::Keyboard::Scancode::F3:
+                showFrameStats = !showFrameStats;
                 break;
-            }
-            case sf::Keyboard::Scancode::Right:
-            case sf::Keyboard::Scancode::D:
-            {
-                Tetromino next{currentTetromino};
-                next.pos.x += 1;
-                if (gameManager.isValidPosition(next))
-                {
-                    currentTetromino.pos.x = next.pos.x;
-                    if (!wasGrounded && gameManager.isGrounded(currentTetromino))
-                    {
-                        lockDelayClock.restart();
-                        lockCounter++;
-                    }
-                }
-                break;
-            }
-            case sf::Keyboard::Scancode::Down:
-            case sf::Keyboard::Scancode::S:
-            {
-                Tetromino next{currentTetromino};
-                next.pos.y += 1;
-                if (gameManager.isValidPosition(next))
-                {
-                    currentTetromino.pos.y = next.pos.y;
-                    lockDelayClock.restart();
-                }
-                else
-                {
-                    if (lockDelayElapsed.asSeconds() >= LOCK_DELAY || lockCounter >= LOCK_LIMIT)
-                    {
-                        gameManager.handleCollision(currentTetromino);
-                        gameManager.handleWreck(currentTetromino, bag);
-                        lockDelayClock.restart();
-                        lockCounter = 0;
-                    }
-                }
-                break;
-            }
-            case sf::Keyboard::Scancode::Left:
-            case sf::Keyboard::Scancode::A:
-            {
-                Tetromino next{currentTetromino};
-                next.pos.x -= 1;
-                if (gameManager.isValidPosition(next))
-                {
-                    currentTetromino.pos.x = next.pos.x;
-                    if (!wasGrounded && gameManager.isGrounded(currentTetromino))
-                    {
-                        lockDelayClock.restart();
-                        lockCounter++;
-                    }
-                }
+            case sf::Keyboard::Scancode::F9:
+                dumpTrace();
                 break;
-            }
-            case sf::Keyboard::Scancode::Space:
-            {
-                while (gameManager.isValidPosition(currentTetromino))
-                {
-                    currentTetromino.pos.y++;
-                }
-                currentTetromino.pos.y--;
-                gameManager.handleCollision(currentTetromino);
-                gameManager.handleWreck(currentTetromino, bag);
-                lockDelayClock.restart();
-                lockCounter = 0;
-                hardDropSound.play();
+            case sf::Keyboard::Scancode::F4:
+                togglePracticeMode();
                 break;
-            }
-            case sf::Keyboard::Scancode::R:
-            {
-                bag = gameManager.generateBag();
-                std::optional<Tetromino> next{gameManager.newTetromino(bag[0])};
-                if (next)
-                {
-                    for (int i = 0; i < GRID_HEIGHT; i++)
-                    {
-                        for (int j = 0; j < GRID_WIDTH; j++)
-                        {
-                            gameManager.screenState[i][j] = EMPTY;
-                        }
-                    }
-                    gameManager.setScore(0);
-                    gameManager.setLevel(1);
-                    gameManager.setCanHold(true);
-                    gameManager.setHasHeld(false);
-                    lockDelayClock.restart();
-                    lockCounter = 0;
-                    gameManager.setHeldTetromino(Tetromino());
-                    currentTetromino = *next;
-                    bag.erase(bag.begin());
-                    themeMusic.setPlayingOffset(sf::seconds(1.0f));
-                }
+            case sf::Keyboard::Scancode::F6:
+                toggleAutoplay();
                 break;
-            }
-            case sf::Keyboard::Scancode::C:
-            {
-                if (gameManager.holdTetromino(currentTetromino, bag))
-                {
-                    lockDelayClock.restart();
-                    lockCounter = 0;
-                    holdSound.play();
-                }
-                else
-                {
-                    invalidSound.play();
-                }
-
+            case sf::Keyboard::Scancode::Backspace:
+                rewindHeld = true;
                 break;
-            }
             default:
+                queueInput(keyPressed->scancode, true);
                 break;
             }
         }
+        else if (const auto *keyReleased{event->getIf<sf::Event::KeyReleased>()})
+        {
+            if (keyReleased->scancode == sf::Keyboard::Scancode::Backspace)
+                rewindHeld = false;
+            else
+                queueInput(keyReleased->scancode, false);
+        }
+        else if (event->is<sf::Event::FocusLost>())
+        {
+            // Releases would never arrive while another window has focus
+            pendingInputs.clear();
+            inputHandler.releaseAll();
+            heldButtons = 0;
+            rewindHeld = false;
+        }
     }
-}
\ No newline at end of file
+}
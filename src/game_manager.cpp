@@ -1,72 +1,27 @@
 #include "game_manager.hpp"
+#include "trace.hpp"
 
-void GameManager::initializeTetrominoes()
+std::array<Tetromino, BAG_SIZE> GameManager::generateBag()
 {
-    for (Tetromino &tetromino : tetrominoes)
+    std::array<Tetromino, BAG_SIZE> bag{};
+    for (Tetromino &tetromino : bag)
     {
-        switch (tetromino.id)
-        {
-        case 'O':
-            tetromino.piece[0][0] = tetromino.color;
-            tetromino.piece[0][1] = tetromino.color;
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            break;
-        case 'I':
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            tetromino.piece[1][2] = tetromino.color;
-            tetromino.piece[1][3] = tetromino.color;
-            break;
-        case 'S':
-            tetromino.piece[0][1] = tetromino.color;
-            tetromino.piece[0][2] = tetromino.color;
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            break;
-        case 'Z':
-            tetromino.piece[0][0] = tetromino.color;
-            tetromino.piece[0][1] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            tetromino.piece[1][2] = tetromino.color;
-            break;
-        case 'L':
-            tetromino.piece[0][2] = tetromino.color;
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            tetromino.piece[1][2] = tetromino.color;
-            break;
-        case 'J':
-            tetromino.piece[0][0] = tetromino.color;
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            tetromino.piece[1][2] = tetromino.color;
-            break;
-        case 'T':
-            tetromino.piece[0][1] = tetromino.color;
-            tetromino.piece[1][0] = tetromino.color;
-            tetromino.piece[1][1] = tetromino.color;
-            tetromino.piece[1][2] = tetromino.color;
-            break;
-        }
+        tetromino = Tetromino{randomizer.next()};
     }
+    return bag;
 }
 
-std::vector<Tetromino> GameManager::generateBag()
+void GameManager::fillQueue(PieceQueue &queue)
 {
-    std::vector<Tetromino> bag{tetrominoes};
-
-    std::random_device rd;
-    std::mt19937 mt(rd());
-    std::shuffle(bag.begin(), bag.end(), mt);
-    return bag;
+    while (queue.size() < PIECE_QUEUE_LENGTH)
+        queue.push(Tetromino{randomizer.next()});
 }
 
-bool GameManager::tryRotate(Tetromino &currentTetromino, const Tetromino &rotatedPiece)
+bool GameManager::tryRotate(Tetromino &currentTetromino, const Tetromino &rotatedPiece) const
 {
     const int8_t startRot = currentTetromino.rotationIndex;
     const int8_t endRot = rotatedPiece.rotationIndex;
-    if (rotatedPiece.id == 'I')
+    if (rotatedPiece.type == PieceType::I)
     {
         const int8_t nextRotCW = (startRot + 1) % 4;
         const bool isCW = (endRot == nextRotCW);
@@ -103,114 +58,98 @@ bool GameManager::tryRotate(Tetromino &currentTetromino, const Tetromino &rotate
     return false;
 }
 
-std::optional<Tetromino> GameManager::newTetromino(const Tetromino &tetromino)
+std::optional<Tetromino> GameManager::newTetromino(const Tetromino &tetromino) const
 {
     Tetromino temp{tetromino};
     temp.initializePosition();
 
-    for (int i = 0; i < temp.squareSize; i++)
-    {
-        for (int j = 0; j < temp.squareSize; j++)
-        {
-            int8_t gridX = temp.pos.x + j;
-            int8_t gridY = temp.pos.y + i;
-            if (gridY >= 0 && gridY < GRID_HEIGHT && gridX >= 0 && gridX < GRID_WIDTH)
-            {
-                if (screenState[gridY][gridX] != EMPTY && temp.piece[i][j] != EMPTY)
-                {
-                    return std::nullopt;
-                }
-            }
-        }
-    }
+    if (board.collides(temp.mask(), temp.pos.x, temp.pos.y))
+        return std::nullopt;
 
     return temp;
 }
 
-bool GameManager::isValidPosition(const Tetromino &tetromino, int8_t deltaX, int8_t deltaY)
+bool GameManager::isValidPosition(const Tetromino &tetromino, int8_t deltaX, int8_t deltaY) const
 {
-    for (int i = 0; i < tetromino.squareSize; i++)
-    {
-        for (int j = 0; j < tetromino.squareSize; j++)
-        {
-            if (tetromino.piece[i][j] != EMPTY)
-            {
-                const int8_t gridX = tetromino.pos.x + j + deltaX;
-                const int8_t gridY = tetromino.pos.y + i + deltaY;
-
-                if (gridX < 0 || gridX >= GRID_WIDTH)
-                {
-                    return false;
-                }
-                if (gridY >= GRID_HEIGHT)
-                {
-                    return false;
-                }
-                if (gridY >= 0 && screenState[gridY][gridX] != EMPTY)
-                {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+    return !board.collides(tetromino.mask(), tetromino.pos.x + deltaX, tetromino.pos.y + deltaY);
 }
-bool GameManager::isGrounded(const Tetromino &tetromino)
+bool GameManager::isGrounded(const Tetromino &tetromino) const
 {
-    Tetromino next = tetromino;
-    next.pos.y++;
-    return !isValidPosition(next);
+    return !isValidPosition(tetromino, 0, 1);
 }
 
-void GameManager::handleCollision(const Tetromino &tetromino)
+// Rows the piece can fall before landing. When every bottom cell sits above the
+// highest filled cell of its column, the piece lands as soon as one of them reaches
+// its column's surface, which is a few subtractions; the bound starts at the full
+// board height since a piece in the hidden rows falls further than the visible
+// field. A piece tucked under an overhang falls back to stepping down one row at a time.
+int8_t GameManager::dropDistance(const Tetromino &tetromino) const
 {
-    for (int i = 0; i < tetromino.squareSize; i++)
+    const PieceProfile &bottom{tetromino.bottom()};
+    int distance{Board::TOTAL_HEIGHT};
+    for (int j = 0; j < 4; j++)
     {
-        for (int j = 0; j < tetromino.squareSize; j++)
-        {
-            if (tetromino.piece[i][j] != EMPTY)
-            {
-                int gridX{tetromino.pos.x + j};
-                int gridY{tetromino.pos.y + i};
-
-                if (gridY >= 0 && gridY < GRID_HEIGHT && gridX >= 0 && gridX < GRID_WIDTH)
-                    screenState[gridY][gridX] = tetromino.piece[i][j];
-            }
-        }
+        if (bottom[j] == NO_CELL)
+            continue;
+        const int surfaceRow{GRID_HEIGHT - board.columnHeights[tetromino.pos.x + j]};
+        distance = std::min(distance, surfaceRow - 1 - (tetromino.pos.y + bottom[j]));
     }
+    if (distance >= 0)
+        return static_cast<int8_t>(distance);
+
+    int8_t steps{};
+    while (isValidPosition(tetromino, 0, steps + 1))
+        steps++;
+    return steps;
+}
+
+void GameManager::handleCollision(const Tetromino &tetromino)
+{
+    board.place(tetromino.mask(), tetromino.pos.x, tetromino.pos.y, tetromino.color());
     canHold = true;
 }
 
-void GameManager::handleWreck(Tetromino &tetromino, std::vector<Tetromino> &bag)
+bool GameManager::handleWreck(Tetromino &tetromino, PieceQueue &queue, bool forceTopOut)
 {
-    std::optional<Tetromino> nextTetromino{newTetromino(bag[0])};
-    if (!nextTetromino)
+    std::optional<Tetromino> nextTetromino{newTetromino(queue.front())};
+    const bool toppedOut{forceTopOut || !nextTetromino};
+    if (toppedOut)
     {
-        for (int i = 0; i < GRID_HEIGHT; i++)
-        {
-            for (int j = 0; j < GRID_WIDTH; j++)
-            {
-                screenState[i][j] = EMPTY;
-            }
-        }
-        bag = generateBag();
-        nextTetromino = newTetromino(bag[0]);
-        score = 0;
-        level = 1;
-        lockCounter = 0;
-        canHold = true;
-        hasHeld = false;
-        themeMusic.setPlayingOffset(sf::seconds(1.0f));
-        heldTetromino = Tetromino();
+        reset(queue);
+        nextTetromino = newTetromino(queue.front());
     }
     if (nextTetromino)
     {
         tetromino = *nextTetromino;
-        bag.erase(bag.begin());
+        queue.popFront();
+        fillQueue(queue);
     }
+    return toppedOut;
+}
+
+// A new game starts on fresh pieces; whatever was queued is dropped
+void GameManager::reset(PieceQueue &queue)
+{
+    board.clear();
+    queue.clear();
+    fillQueue(queue);
+    score = 0;
+    level = 1;
+    statsRevision++;
+    canHold = true;
+    hasHeld = false;
+    heldTetromino = Tetromino();
+}
+
+uint64_t GameManager::positionHash(const Tetromino &current, const PieceQueue &queue, uint8_t previewCount) const
+{
+    uint64_t hash{board.hash ^ zobristPiece(current.type) ^ zobristHold(heldTetromino.type, canHold)};
+    for (uint8_t i = 0; i < std::min(previewCount, queue.size()); i++)
+        hash ^= zobristQueue(i, queue[i].type);
+    return hash;
 }
 
-bool GameManager::holdTetromino(Tetromino &tetromino, std::vector<Tetromino> &bag)
+bool GameManager::holdTetromino(Tetromino &tetromino, PieceQueue &queue)
 {
     if (!canHold)
         return false;
@@ -218,7 +157,7 @@ bool GameManager::holdTetromino(Tetromino &tetromino, std::vector<Tetromino> &ba
 
     if (!hasHeld)
     {
-        auto nextTetromino = newTetromino(*bag.begin());
+        auto nextTetromino = newTetromino(queue.front());
         if (!nextTetromino)
         {
             canHold = false;
@@ -226,7 +165,8 @@ bool GameManager::holdTetromino(Tetromino &tetromino, std::vector<Tetromino> &ba
         }
         heldTetromino = tetromino;
         tetromino = *nextTetromino;
-        bag.erase(bag.begin());
+        queue.popFront();
+        fillQueue(queue);
         hasHeld = true;
     }
     else
@@ -237,60 +177,19 @@ bool GameManager::holdTetromino(Tetromino &tetromino, std::vector<Tetromino> &ba
             canHold = false;
             return false;
         }
-        Tetromino temp = heldTetromino;
         heldTetromino = tetromino;
         tetromino = *nextTetromino;
     }
 
     heldTetromino.initializePosition();
-    // rotate till its at the default rotation
-    while (heldTetromino.rotationIndex != 0)
-    {
-        heldTetromino = heldTetromino.rotatedCCW();
-    }
+    heldTetromino.rotationIndex = 0;
     return true;
 }
 
-void GameManager::clearRows()
+uint8_t GameManager::clearRows()
 {
-    int8_t writeRow{GRID_HEIGHT - 1};
-    int8_t rowsCleared{};
-    for (int i = GRID_HEIGHT - 1; i >= 0; i--)
-    {
-        bool fullRow{true};
-        for (int j = 0; j < GRID_WIDTH; j++)
-        {
-            if (screenState[i][j] == EMPTY)
-            {
-                fullRow = false;
-                break;
-            }
-        }
-
-        if (!fullRow)
-        {
-
-            if (i != writeRow)
-            {
-                for (int j = 0; j < GRID_WIDTH; j++)
-                {
-                    screenState[writeRow][j] = screenState[i][j];
-                }
-            }
-            writeRow--;
-        }
-        else
-        {
-            rowsCleared++;
-        }
-    }
-    for (int i = writeRow; i >= 0; i--)
-    {
-        for (int j = 0; j < GRID_WIDTH; j++)
-        {
-            screenState[i][j] = EMPTY;
-        }
-    }
+    TRACE_SCOPE("GameManager::clearRows");
+    const uint8_t rowsCleared{board.clearFullRows()};
     switch (rowsCleared)
     {
     case 1:
@@ -307,5 +206,9 @@ void GameManager::clearRows()
         break;
     }
     if (rowsCleared > 0)
+    {
         level = (score / 500) + 1;
+        statsRevision++;
+    }
+    return rowsCleared;
 }
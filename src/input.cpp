@@ -0,0 +1,93 @@
+#include "input.hpp"
+#include <algorithm>
+
+void InputHandler::startShift(Action direction)
+{
+    shiftDirection = direction;
+    shiftElapsed = 0;
+    slideDue = true;
+}
+
+void InputHandler::press(Action button, std::vector<Action> &actions)
+{
+    if (isHeld(button))
+        return;
+    held[static_cast<uint8_t>(button)] = true;
+
+    if (button == Action::MOVE_LEFT || button == Action::MOVE_RIGHT)
+        startShift(button);
+    else if (button == Action::SOFT_DROP)
+        softDropElapsed = 0;
+    actions.push_back(button);
+}
+
+void InputHandler::release(Action button)
+{
+    held[static_cast<uint8_t>(button)] = false;
+    if (shiftDirection != button)
+        return;
+
+    // Falling back to the other held direction charges its auto shift from scratch
+    const Action other{button == Action::MOVE_LEFT ? Action::MOVE_RIGHT : Action::MOVE_LEFT};
+    if (isHeld(other))
+        startShift(other);
+    else
+        shiftDirection.reset();
+}
+
+void InputHandler::releaseAll()
+{
+    held.fill(false);
+    shiftDirection.reset();
+}
+
+void InputHandler::setHeld(uint8_t buttons, std::vector<Action> &actions)
+{
+    for (uint8_t i = 0; i < ACTION_COUNT; i++)
+    {
+        const bool down{(buttons >> i & 1) != 0};
+        if (down && !held[i])
+            press(static_cast<Action>(i), actions);
+        else if (!down && held[i])
+            release(static_cast<Action>(i));
+    }
+}
+
+void InputHandler::handleEvents(uint8_t events)
+{
+    if (events & (EVENT_HELD | EVENT_LOCKED | EVENT_TOPPED_OUT | EVENT_RESET))
+        slideDue = true;
+}
+
+void InputHandler::tick(uint16_t gravityDelayTicks, std::vector<Action> &actions)
+{
+    if (shiftDirection)
+    {
+        shiftElapsed++;
+        if (settings.arrTicks == 0)
+        {
+            if (shiftElapsed >= settings.dasTicks && slideDue)
+            {
+                actions.insert(actions.end(), GRID_WIDTH, *shiftDirection);
+                slideDue = false;
+            }
+            shiftElapsed = std::min(shiftElapsed, settings.dasTicks);
+        }
+        else if (shiftElapsed == settings.dasTicks || shiftElapsed == settings.dasTicks + settings.arrTicks)
+        {
+            actions.push_back(*shiftDirection);
+            // Count repeats from the end of DAS so a long hold never overflows the counter
+            shiftElapsed = settings.dasTicks;
+        }
+    }
+
+    if (isHeld(Action::SOFT_DROP))
+    {
+        const uint16_t softDropTicks{static_cast<uint16_t>(std::max(1, gravityDelayTicks / std::max<int>(settings.softDropFactor, 1)))};
+        if (++softDropElapsed >= softDropTicks)
+        {
+            actions.push_back(Action::SOFT_DROP);
+            softDropElapsed = 0;
+        }
+    }
+}
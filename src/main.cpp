@@ -5,8 +5,66 @@
 #include <chrono>
 #include <iomanip>
 #include <ctime>
+#include <cstring>
 
-int main()
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+// The running executable as the OS knows it, so neither the working directory nor a
+// launch through PATH or a symlink changes it; empty when the OS cannot tell
+static std::filesystem::path executablePath()
+{
+#ifdef _WIN32
+    std::wstring path(MAX_PATH, L'\0');
+    for (;;)
+    {
+        const DWORD length{GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()))};
+        if (length == 0)
+            return {};
+        // A path that filled the buffer may have been cut short
+        if (length < path.size())
+        {
+            path.resize(length);
+            return path;
+        }
+        path.resize(path.size() * 2);
+    }
+#elif defined(__APPLE__)
+    uint32_t size{};
+    _NSGetExecutablePath(nullptr, &size);
+    std::string path(size, '\0');
+    if (_NSGetExecutablePath(path.data(), &size) != 0)
+        return {};
+    path.resize(std::strlen(path.c_str()));
+    // The path may still go through a symlink
+    std::error_code error;
+    const std::filesystem::path resolved{std::filesystem::canonical(path, error)};
+    return error ? std::filesystem::path(path) : resolved;
+#else
+    std::error_code error;
+    const std::filesystem::path path{std::filesystem::read_symlink("/proc/self/exe", error)};
+    return error ? std::filesystem::path() : path;
+#endif
+}
+
+// Prefers the archive next to the executable, so the game starts from any working directory,
+// and falls back to the working directory only when that one is missing
+static std::filesystem::path findAssetArchive()
+{
+    const std::filesystem::path executable{executablePath()};
+    if (executable.empty())
+        return std::filesystem::path(ASSET_ARCHIVE_NAME);
+    std::error_code error;
+    const std::filesystem::path besideExecutable{executable.parent_path() / ASSET_ARCHIVE_NAME};
+    return std::filesystem::exists(besideExecutable, error) ? besideExecutable : std::filesystem::path(ASSET_ARCHIVE_NAME);
+}
+
+int main(int argc, char **argv)
 {
     std::ofstream g_errorLog("error_log.log", std::ios::app);
 
@@ -20,7 +78,30 @@ int main()
     }
     try
     {
-        Game game;
+        // A lone argument is a replay to play back; the netplay options start a versus match,
+        // --royale PLAYERS a battle royale against bots, --autoplay hands the game to the beam bot
+        // and --preview N shows that many queued pieces
+        GameOptions options;
+        options.assetPath = findAssetArchive();
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg{argv[i]};
+            NetplayOptions netplay{options.netplay.value_or(NetplayOptions{})};
+            if (i + 1 < argc && parseNetplayOption(arg, argv[i + 1], netplay))
+            {
+                options.netplay = netplay;
+                i++;
+            }
+            else if (arg == "--royale" && i + 1 < argc)
+                options.royalePlayers = static_cast<uint8_t>(std::min<unsigned long>(std::stoul(argv[++i]), UINT8_MAX));
+            else if (arg == "--autoplay")
+                options.autoplay = true;
+            else if (arg == "--preview" && i + 1 < argc)
+                options.previewCount = static_cast<uint8_t>(std::min<unsigned long>(std::stoul(argv[++i]), UINT8_MAX));
+            else
+                options.replayPath = arg;
+        }
+        Game game(options);
         game.run();
     }
     catch (const std::runtime_error &e)
@@ -0,0 +1,107 @@
+#include "mapped_file.hpp"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path &path)
+{
+#ifdef _WIN32
+    HANDLE file{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open " + path.string() + ".\n");
+    }
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(file, &fileSize);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length > 0)
+    {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            bytes = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    CloseHandle(file);
+    if (length > 0 && !bytes)
+    {
+        unmap();
+        throw std::runtime_error("Failed to map " + path.string() + ".\n");
+    }
+#else
+    const int file{open(path.c_str(), O_RDONLY)};
+    if (file < 0)
+    {
+        throw std::runtime_error("Failed to open " + path.string() + ".\n");
+    }
+    struct stat info{};
+    fstat(file, &info);
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0)
+    {
+        void *address{mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0)};
+        if (address != MAP_FAILED)
+        {
+            bytes = static_cast<const uint8_t *>(address);
+            madvise(address, length, MADV_SEQUENTIAL);
+        }
+    }
+    close(file);
+    if (length > 0 && !bytes)
+    {
+        throw std::runtime_error("Failed to map " + path.string() + ".\n");
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0))
+#ifdef _WIN32
+      ,
+      mapping(std::exchange(other.mapping, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        mapping = std::exchange(other.mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping)
+        CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (bytes)
+        munmap(const_cast<uint8_t *>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
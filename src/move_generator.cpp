@@ -0,0 +1,226 @@
+#include "move_generator.hpp"
+#include <algorithm>
+
+constexpr uint16_t NO_PARENT{0xFFFF};
+
+static bool inSearchSpace(const Tetromino &tetromino)
+{
+    return tetromino.pos.x + MOVEGEN_X_OFFSET >= 0 && tetromino.pos.x + MOVEGEN_X_OFFSET < MOVEGEN_X_SPAN &&
+           tetromino.pos.y + MOVEGEN_Y_OFFSET >= 0 && tetromino.pos.y + MOVEGEN_Y_OFFSET < MOVEGEN_Y_SPAN;
+}
+
+static uint16_t nodeIndex(const Tetromino &tetromino)
+{
+    return static_cast<uint16_t>(((tetromino.rotationIndex * MOVEGEN_Y_SPAN) + tetromino.pos.y + MOVEGEN_Y_OFFSET) * MOVEGEN_X_SPAN +
+                                 tetromino.pos.x + MOVEGEN_X_OFFSET);
+}
+
+static Tetromino shifted(const Tetromino &tetromino, int8_t deltaX, int8_t deltaY)
+{
+    Tetromino moved{tetromino};
+    moved.pos.x += deltaX;
+    moved.pos.y += deltaY;
+    return moved;
+}
+
+// Identifies a lock position by the board cells it fills, so symmetric rotations collapse
+static uint64_t cellKey(const Tetromino &tetromino)
+{
+    const PieceMask &mask{tetromino.mask()};
+    uint64_t key{};
+    int firstRow{-1};
+    for (int i = 0; i < static_cast<int>(mask.size()); i++)
+    {
+        if (mask[i] == 0)
+            continue;
+        if (firstRow < 0)
+            firstRow = i;
+        const uint64_t bits{static_cast<uint64_t>(tetromino.pos.x >= 0 ? mask[i] << tetromino.pos.x : mask[i] >> -tetromino.pos.x)};
+        key |= bits << ((i - firstRow) * GRID_WIDTH);
+    }
+    return key | (static_cast<uint64_t>(tetromino.pos.y + firstRow + MOVEGEN_Y_OFFSET) << (4 * GRID_WIDTH));
+}
+
+void MoveGenerator::generate(const GameManager &gameManager, const Tetromino &current, const Tetromino &next, std::vector<Placement> &placements)
+{
+    placements.clear();
+    seenKeys.clear();
+    search(gameManager, current, false, placements);
+
+    if (gameManager.getCanHold())
+    {
+        const Tetromino &holdSource{gameManager.getHasHeld() ? gameManager.getHeldTetromino() : next};
+        if (std::optional<Tetromino> spawn{gameManager.newTetromino(holdSource)})
+            search(gameManager, *spawn, true, placements);
+    }
+}
+
+void MoveGenerator::generate(const Simulation &simulation, std::vector<Placement> &placements)
+{
+    generate(simulation.getGameManager(), simulation.getCurrentTetromino(), simulation.getQueue().front(), placements);
+}
+
+void MoveGenerator::generateDrops(const GameManager &gameManager, const Tetromino &current, const Tetromino &next, std::vector<Placement> &placements)
+{
+    placements.clear();
+    seenKeys.clear();
+    drops(gameManager, current, false, placements);
+
+    if (gameManager.getCanHold())
+    {
+        const Tetromino &holdSource{gameManager.getHasHeld() ? gameManager.getHeldTetromino() : next};
+        if (std::optional<Tetromino> spawn{gameManager.newTetromino(holdSource)})
+            drops(gameManager, *spawn, true, placements);
+    }
+}
+
+void MoveGenerator::drops(const GameManager &gameManager, const Tetromino &spawn, bool usedHold, std::vector<Placement> &placements)
+{
+    const auto add = [&](const Tetromino &tetromino)
+    {
+        Tetromino landed{tetromino};
+        landed.pos.y += gameManager.dropDistance(tetromino);
+        const uint64_t key{cellKey(landed)};
+        if (std::find(seenKeys.begin(), seenKeys.end(), key) == seenKeys.end())
+        {
+            seenKeys.push_back(key);
+            placements.push_back({landed, usedHold, 0});
+        }
+    };
+
+    Tetromino rotated{spawn};
+    const int rotations{spawn.type == PieceType::O ? 1 : 4};
+    for (int r = 0; r < rotations; r++)
+    {
+        if (r > 0 && !gameManager.tryRotate(rotated, rotated.rotatedCW()))
+            break;
+        add(rotated);
+        for (const int8_t deltaX : {int8_t{-1}, int8_t{1}})
+        {
+            for (Tetromino moved{rotated}; gameManager.isValidPosition(moved, deltaX, 0);)
+            {
+                moved.pos.x += deltaX;
+                add(moved);
+            }
+        }
+    }
+}
+
+void MoveGenerator::search(const GameManager &gameManager, const Tetromino &spawn, bool usedHold, std::vector<Placement> &placements)
+{
+    SearchTree &tree{trees[usedHold]};
+    tree.visited.reset();
+
+    size_t head{};
+    size_t tail{};
+    const uint16_t root{nodeIndex(spawn)};
+    tree.visited.set(root);
+    tree.parent[root] = NO_PARENT;
+    tree.queue[tail++] = spawn;
+
+    while (head < tail)
+    {
+        const Tetromino node{tree.queue[head++]};
+        const uint16_t index{nodeIndex(node)};
+
+        Tetromino landed{node};
+        landed.pos.y += gameManager.dropDistance(node);
+        const uint64_t key{cellKey(landed)};
+        if (std::find(seenKeys.begin(), seenKeys.end(), key) == seenKeys.end())
+        {
+            seenKeys.push_back(key);
+            placements.push_back({landed, usedHold, index});
+        }
+
+        const auto visit = [&](const Tetromino &child, Action action)
+        {
+            if (!inSearchSpace(child))
+                return;
+            const uint16_t childIndex{nodeIndex(child)};
+            if (tree.visited.test(childIndex))
+                return;
+            tree.visited.set(childIndex);
+            tree.parent[childIndex] = index;
+            tree.via[childIndex] = action;
+            tree.queue[tail++] = child;
+        };
+
+        if (gameManager.isValidPosition(node, -1, 0))
+            visit(shifted(node, -1, 0), Action::MOVE_LEFT);
+        if (gameManager.isValidPosition(node, 1, 0))
+            visit(shifted(node, 1, 0), Action::MOVE_RIGHT);
+        if (gameManager.isValidPosition(node, 0, 1))
+            visit(shifted(node, 0, 1), Action::SOFT_DROP);
+        if (node.type == PieceType::O)
+            continue;
+
+        Tetromino rotated{node};
+        if (gameManager.tryRotate(rotated, node.rotatedCW()))
+            visit(rotated, Action::ROTATE_CW);
+        rotated = node;
+        if (gameManager.tryRotate(rotated, node.rotatedCCW()))
+            visit(rotated, Action::ROTATE_CCW);
+    }
+}
+
+void MoveGenerator::path(const Placement &placement, std::vector<Action> &actions) const
+{
+    const SearchTree &tree{trees[placement.usedHold]};
+    actions.clear();
+    for (uint16_t node = placement.node; tree.parent[node] != NO_PARENT; node = tree.parent[node])
+        actions.push_back(tree.via[node]);
+    if (placement.usedHold)
+        actions.push_back(Action::HOLD);
+    std::reverse(actions.begin(), actions.end());
+    actions.push_back(Action::HARD_DROP);
+}
+
+uint64_t MoveGenerator::perft(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, TranspositionTable *table)
+{
+    perftPlacements.resize(depth);
+    return perftLevel(gameManager, queue, depth, 0, table);
+}
+
+uint64_t MoveGenerator::perftLevel(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, uint8_t ply, TranspositionTable *table)
+{
+    if (ply == depth)
+        return 1;
+
+    // A subtree's count depends only on the board and the pieces still to come
+    uint64_t key{gameManager.board.hash ^ zobristKey(ZOBRIST_EXTRA_KEYS + depth - ply)};
+    for (uint8_t i = ply; i < depth && i < queue.size(); i++)
+        key ^= zobristQueue(static_cast<uint8_t>(i - ply), queue[i]);
+    if (table && ply > 0)
+    {
+        if (const std::optional<TableHit> hit{table->probe(key)})
+            return hit->value;
+    }
+    const uint64_t count{perftCount(gameManager, queue, depth, ply, table)};
+    if (table && ply > 0)
+        table->store(key, count, static_cast<uint8_t>(depth - ply));
+    return count;
+}
+
+uint64_t MoveGenerator::perftCount(const GameManager &gameManager, const std::vector<PieceType> &queue, uint8_t depth, uint8_t ply, TranspositionTable *table)
+{
+    std::optional<Tetromino> spawn{ply < queue.size() ? gameManager.newTetromino(Tetromino{queue[ply]}) : std::nullopt};
+    if (!spawn)
+        return 0;
+
+    std::vector<Placement> &placements{perftPlacements[ply]};
+    placements.clear();
+    seenKeys.clear();
+    search(gameManager, *spawn, false, placements);
+    if (ply + 1 == depth)
+        return placements.size();
+
+    uint64_t count{};
+    for (const Placement &placement : placements)
+    {
+        GameManager child{gameManager};
+        child.handleCollision(placement.tetromino);
+        child.clearRows();
+        count += perftLevel(child, queue, depth, ply + 1, table);
+    }
+    return count;
+}
@@ -0,0 +1,289 @@
+#include "netplay.hpp"
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t MAX_PACKET_SIZE{1024};
+
+    void writeField(std::vector<uint8_t> &out, uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+            out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    // Packets come off the network, so running past the end marks the packet bad instead of throwing
+    struct PacketReader
+    {
+        const uint8_t *cursor;
+        const uint8_t *end;
+        bool valid{true};
+
+        uint64_t read(int bytes)
+        {
+            if (end - cursor < bytes)
+            {
+                valid = false;
+                return 0;
+            }
+            uint64_t value{};
+            for (int i = 0; i < bytes; i++)
+                value |= uint64_t{*cursor++} << (i * 8);
+            return value;
+        }
+    };
+
+    void writeSettings(std::vector<uint8_t> &out, const InputSettings &settings)
+    {
+        writeField(out, settings.dasTicks, 2);
+        writeField(out, settings.arrTicks, 2);
+        writeField(out, settings.softDropFactor, 1);
+    }
+
+    InputSettings readSettings(PacketReader &reader)
+    {
+        InputSettings settings;
+        settings.dasTicks = static_cast<uint16_t>(reader.read(2));
+        settings.arrTicks = static_cast<uint16_t>(reader.read(2));
+        settings.softDropFactor = static_cast<uint8_t>(reader.read(1));
+        return settings;
+    }
+}
+
+bool parseNetplayOption(const std::string &arg, const std::string &value, NetplayOptions &options)
+{
+    if (arg == "--host")
+    {
+        options.hosting = true;
+        options.port = static_cast<uint16_t>(std::stoul(value));
+    }
+    else if (arg == "--join")
+    {
+        options.hosting = false;
+        options.hostAddress = value;
+    }
+    else if (arg == "--latency")
+        options.conditions.latencyMs = static_cast<uint16_t>(std::stoul(value));
+    else if (arg == "--jitter")
+        options.conditions.jitterMs = static_cast<uint16_t>(std::stoul(value));
+    else if (arg == "--loss")
+        options.conditions.lossPercent = std::stof(value);
+    else
+        return false;
+    return true;
+}
+
+Netplay::Netplay(const NetplayOptions &_options)
+    : options(_options), origin(std::chrono::steady_clock::now()), socket(options.hosting ? options.port : uint16_t{0}),
+      conditionsRng(static_cast<uint64_t>(origin.time_since_epoch().count()))
+{
+    if (!options.hosting)
+        peer = resolveUdpAddress(options.hostAddress);
+}
+
+uint32_t Netplay::nowMs() const
+{
+    const auto elapsed{std::chrono::steady_clock::now() - origin};
+    // Zero is kept free to mean "nothing to echo"
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()) + 1;
+}
+
+std::vector<uint8_t> Netplay::startPacket(PacketType type) const
+{
+    std::vector<uint8_t> packet(NETPLAY_MAGIC.begin(), NETPLAY_MAGIC.end());
+    packet.push_back(NETPLAY_VERSION);
+    packet.push_back(type);
+    return packet;
+}
+
+// Every packet goes through the artificial conditions, which are a no-op by default
+void Netplay::send(std::vector<uint8_t> packet)
+{
+    if (!peer)
+        return;
+    if (options.conditions.lossPercent > 0.0f &&
+        conditionsRng.below(10000) < static_cast<uint32_t>(options.conditions.lossPercent * 100.0f))
+        return;
+    const uint32_t delay{options.conditions.latencyMs + (options.conditions.jitterMs > 0 ? conditionsRng.below(options.conditions.jitterMs + 1u) : 0u)};
+    if (delay == 0)
+    {
+        socket.send(*peer, packet.data(), packet.size());
+        return;
+    }
+    delayed.push_back({nowMs() + delay, std::move(packet)});
+}
+
+void Netplay::flushDelayed()
+{
+    const uint32_t now{nowMs()};
+    for (auto it = delayed.begin(); it != delayed.end();)
+    {
+        if (it->releaseMs > now)
+        {
+            ++it;
+            continue;
+        }
+        socket.send(*peer, it->bytes.data(), it->bytes.size());
+        it = delayed.erase(it);
+    }
+}
+
+void Netplay::poll()
+{
+    uint8_t buffer[MAX_PACKET_SIZE];
+    size_t size{};
+    UdpAddress from;
+    while (socket.receive(buffer, sizeof(buffer), size, from))
+        handlePacket(buffer, size, from);
+
+    const uint32_t now{nowMs()};
+    if (!options.hosting && !session && now - lastHelloMs >= NETPLAY_HELLO_INTERVAL_MS)
+    {
+        std::vector<uint8_t> hello{startPacket(PACKET_HELLO)};
+        writeSettings(hello, options.inputSettings);
+        send(std::move(hello));
+        lastHelloMs = now;
+    }
+    flushDelayed();
+}
+
+void Netplay::handlePacket(const uint8_t *data, size_t size, const UdpAddress &from)
+{
+    const size_t headerSize{NETPLAY_MAGIC.size() + 2};
+    if (size < headerSize || !std::equal(NETPLAY_MAGIC.begin(), NETPLAY_MAGIC.end(), data) || data[NETPLAY_MAGIC.size()] != NETPLAY_VERSION)
+        return;
+    // A host takes the first guest to say hello and ignores everyone else
+    if (options.hosting && !peer && data[NETPLAY_MAGIC.size() + 1] == PACKET_HELLO)
+        peer = from;
+    if (!peer || from != *peer)
+        return;
+    lastReceiveMs = nowMs();
+
+    PacketReader reader{data + headerSize, data + size};
+    switch (data[NETPLAY_MAGIC.size() + 1])
+    {
+    case PACKET_HELLO:
+    {
+        const InputSettings guestSettings{readSettings(reader)};
+        if (!reader.valid || !options.hosting)
+            return;
+        if (!session)
+            session.emplace(0, options.seed, std::array<InputSettings, VERSUS_PLAYERS>{options.inputSettings, guestSettings});
+        // Answered every time, since the previous welcome may have been lost
+        std::vector<uint8_t> welcome{startPacket(PACKET_WELCOME)};
+        writeField(welcome, options.seed, 8);
+        writeSettings(welcome, options.inputSettings);
+        send(std::move(welcome));
+        break;
+    }
+    case PACKET_WELCOME:
+    {
+        const uint64_t seed{reader.read(8)};
+        const InputSettings hostSettings{readSettings(reader)};
+        if (reader.valid && !options.hosting && !session)
+            session.emplace(1, seed, std::array<InputSettings, VERSUS_PLAYERS>{hostSettings, options.inputSettings});
+        break;
+    }
+    case PACKET_INPUTS:
+        if (session)
+            handleInputs(reader.cursor, reader.end - reader.cursor);
+        break;
+    }
+}
+
+void Netplay::handleInputs(const uint8_t *data, size_t size)
+{
+    PacketReader reader{data, data + size};
+    const uint32_t senderTick{static_cast<uint32_t>(reader.read(4))};
+    const uint32_t ack{static_cast<uint32_t>(reader.read(4))};
+    const uint32_t sendMs{static_cast<uint32_t>(reader.read(4))};
+    const uint32_t echoMs{static_cast<uint32_t>(reader.read(4))};
+    const uint32_t checksumTick{static_cast<uint32_t>(reader.read(4))};
+    const uint64_t checksum{reader.read(8)};
+    const uint32_t firstTick{static_cast<uint32_t>(reader.read(4))};
+    const uint8_t count{static_cast<uint8_t>(reader.read(1))};
+    if (!reader.valid || reader.end - reader.cursor < count)
+        return;
+
+    const uint32_t now{nowMs()};
+    peerAck = std::max(peerAck, ack);
+    // Packets can arrive out of order; only the newest one moves the clocks
+    if (senderTick >= peerTick)
+    {
+        peerTick = senderTick;
+        peerTickReceivedMs = now;
+        peerSendMs = sendMs;
+        peerSendReceivedMs = now;
+        if (echoMs != 0 && now >= echoMs)
+        {
+            const float sample{static_cast<float>(now - echoMs)};
+            roundTripMs = roundTripMs == 0.0f ? sample : roundTripMs * 0.875f + sample * 0.125f;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+        session->receiveRemote(firstTick + i, reader.cursor[i]);
+
+    const std::optional<uint64_t> localChecksum{session->getChecksum(checksumTick)};
+    if (!desyncTick && localChecksum && *localChecksum != checksum)
+        desyncTick = checksumTick;
+}
+
+void Netplay::sendInputs()
+{
+    const uint32_t now{nowMs()};
+    const uint32_t tick{session->getTick()};
+    const uint32_t firstTick{std::max(peerAck, tick - std::min(tick, INPUT_HISTORY - 1))};
+    const uint8_t count{static_cast<uint8_t>(std::min<uint32_t>(tick - firstTick, UINT8_MAX))};
+    const uint32_t checksumTick{session->getLastChecksumTick()};
+
+    std::vector<uint8_t> packet{startPacket(PACKET_INPUTS)};
+    writeField(packet, tick, 4);
+    writeField(packet, session->getRemoteConfirmed(), 4);
+    writeField(packet, now, 4);
+    writeField(packet, peerSendMs != 0 ? peerSendMs + (now - peerSendReceivedMs) : 0, 4);
+    writeField(packet, checksumTick, 4);
+    writeField(packet, session->getChecksum(checksumTick).value_or(0), 8);
+    writeField(packet, firstTick, 4);
+    writeField(packet, count, 1);
+    for (uint32_t i = 0; i < count; i++)
+        packet.push_back(session->getLocalInput(firstTick + i));
+    send(std::move(packet));
+}
+
+// Skips a tick now and then while ahead of where the remote player should be by now,
+// so the side with the lower latency does not keep running into the rollback window
+bool Netplay::shouldStall() const
+{
+    if (peerTickReceivedMs == 0 || ticksSinceStall < TIME_SYNC_SPACING_TICKS)
+        return false;
+    const float elapsedMs{static_cast<float>(nowMs() - peerTickReceivedMs) + roundTripMs / 2.0f};
+    const float remoteTick{static_cast<float>(peerTick) + elapsedMs * TICK_RATE / 1000.0f};
+    return static_cast<float>(session->getTick()) - remoteTick > TIME_SYNC_SLACK_TICKS;
+}
+
+std::optional<uint8_t> Netplay::advance(uint8_t localHeld)
+{
+    if (!session)
+        return std::nullopt;
+
+    std::optional<uint8_t> events;
+    session->resolve();
+    if (session->canAdvance() && !shouldStall())
+    {
+        events = session->advance(localHeld);
+        ticksSinceStall++;
+    }
+    else
+    {
+        stalls++;
+        ticksSinceStall = 0;
+    }
+    sendInputs();
+    flushDelayed();
+    return events;
+}
+
+bool Netplay::isDisconnected() const
+{
+    return session && nowMs() - lastReceiveMs > NETPLAY_TIMEOUT_MS;
+}
@@ -0,0 +1,64 @@
+#include "asset_archive.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    void writeArchive(const std::filesystem::path &path, const std::vector<uint8_t> &archive)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char *>(archive.data()), archive.size()))
+        {
+            throw std::runtime_error("Failed to write archive " + path.string() + ".\n");
+        }
+    }
+
+    // A C++ source defining the archive as an array, for builds that link the assets in
+    void writeEmbeddedSource(const std::filesystem::path &path, const std::vector<uint8_t> &archive)
+    {
+        std::ofstream file(path);
+        file << "// Generated by tetris-pack, do not edit\n"
+             << "#include \"asset_archive.hpp\"\n\n"
+             << "alignas(16) extern const uint8_t EMBEDDED_ASSETS[] = {";
+        const char *digits{"0123456789abcdef"};
+        for (size_t i = 0; i < archive.size(); i++)
+        {
+            file << (i % 24 == 0 ? "\n    " : "") << "0x" << digits[archive[i] >> 4] << digits[archive[i] & 0xF] << ',';
+        }
+        file << "\n};\nextern const size_t EMBEDDED_ASSETS_SIZE{sizeof(EMBEDDED_ASSETS)};\n";
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write embedded archive " + path.string() + ".\n");
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        int first{1};
+        const bool embed{argc > 1 && std::string_view{argv[1]} == "--embed"};
+        if (embed)
+            first++;
+        if (argc - first < 2)
+        {
+            throw std::runtime_error("Usage: tetris-pack [--embed] OUTPUT DIR...\n");
+        }
+
+        std::vector<std::filesystem::path> roots(argv + first + 1, argv + argc);
+        const std::vector<uint8_t> archive{packAssets(roots)};
+        if (embed)
+            writeEmbeddedSource(argv[first], archive);
+        else
+            writeArchive(argv[first], archive);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "tetris-pack: " << e.what();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "randomizer.hpp"
+#include <algorithm>
+
+constexpr uint8_t PIECE_COUNT{7};
+// TGM2 rerolls up to six times to avoid the last four pieces
+constexpr uint8_t HISTORY_ROLLS{6};
+
+static uint64_t rotateLeft(uint64_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+void Xoshiro256::reseed(uint64_t seed)
+{
+    for (uint64_t &word : state)
+    {
+        seed += 0x9E3779B97F4A7C15ull;
+        uint64_t z{seed};
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        word = z ^ (z >> 31);
+    }
+}
+
+uint64_t Xoshiro256::next()
+{
+    const uint64_t result{rotateLeft(state[1] * 5, 7) * 9};
+    const uint64_t t{state[1] << 17};
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+    return result;
+}
+
+// Lemire's multiply-shift range reduction with rejection, so every value is equally likely
+uint32_t Xoshiro256::below(uint32_t bound)
+{
+    uint64_t product{(next() >> 32) * bound};
+    uint32_t low{static_cast<uint32_t>(product)};
+    if (low < bound)
+    {
+        const uint32_t threshold{static_cast<uint32_t>(-bound) % bound};
+        while (low < threshold)
+        {
+            product = (next() >> 32) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+Randomizer::Randomizer(uint64_t _seed, RandomizerMode _mode) : rng(_seed), seed(_seed), mode(_mode)
+{
+    reseed(_seed);
+}
+
+void Randomizer::reseed(uint64_t _seed)
+{
+    seed = _seed;
+    rng.reseed(seed);
+    bagRemaining = 0;
+    history = {PieceType::Z, PieceType::Z, PieceType::S, PieceType::S};
+    firstPiece = true;
+}
+
+PieceType Randomizer::next()
+{
+    switch (mode)
+    {
+    case RandomizerMode::BAG_14:
+        return nextFromBag(2);
+    case RandomizerMode::RANDOM:
+        return nextRandom();
+    case RandomizerMode::HISTORY:
+        return nextFromHistory();
+    case RandomizerMode::BAG_7:
+    default:
+        return nextFromBag(1);
+    }
+}
+
+PieceType Randomizer::nextFromBag(uint8_t copies)
+{
+    if (bagRemaining == 0)
+    {
+        bagRemaining = PIECE_COUNT * copies;
+        for (uint8_t i = 0; i < bagRemaining; i++)
+            bag[i] = static_cast<PieceType>(1 + i % PIECE_COUNT);
+    }
+    // Partial Fisher-Yates: draw a random remaining piece and swap it out of the live range
+    const uint32_t pick{rng.below(bagRemaining)};
+    const PieceType piece{bag[pick]};
+    bag[pick] = bag[--bagRemaining];
+    return piece;
+}
+
+PieceType Randomizer::nextRandom()
+{
+    return static_cast<PieceType>(1 + rng.below(PIECE_COUNT));
+}
+
+PieceType Randomizer::nextFromHistory()
+{
+    PieceType piece{};
+    if (firstPiece)
+    {
+        // Never open with S, Z or O
+        constexpr std::array<PieceType, 4> openers{PieceType::I, PieceType::J, PieceType::L, PieceType::T};
+        piece = openers[rng.below(openers.size())];
+        firstPiece = false;
+    }
+    else
+    {
+        for (uint8_t roll = 0; roll < HISTORY_ROLLS; roll++)
+        {
+            piece = nextRandom();
+            if (std::find(history.begin(), history.end(), piece) == history.end())
+                break;
+        }
+    }
+    std::rotate(history.begin(), history.begin() + 1, history.end());
+    history.back() = piece;
+    return piece;
+}
@@ -1,157 +1,487 @@
 #include "render.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
 
-void Render::drawHeldTetromino(const Tetromino &tetromino)
+constexpr float TOTAL_GRID_WIDTH{GRID_WIDTH * CELL_SIZE};
+constexpr float TOTAL_GRID_HEIGHT{GRID_HEIGHT * CELL_SIZE};
+constexpr float PREVIEW_BOX_SIZE{CELL_SIZE * 6};
+// Pieces after the next one are drawn at this scale, one per slot in a column under the NEXT box
+constexpr float QUEUE_CELL_SIZE{CELL_SIZE * 0.6f};
+constexpr float QUEUE_COLOR_SIZE{COLOR_SIZE * 0.6f};
+constexpr float QUEUE_SLOT_HEIGHT{QUEUE_CELL_SIZE * 3};
+constexpr float OPPONENT_CELL_SIZE{CELL_SIZE * 0.4f};
+// Miniatures fill a column on each side of the playfield, below the level and score text
+constexpr float MINI_REGION_MARGIN{CELL_SIZE / 2};
+constexpr float MINI_REGION_WIDTH{CELL_SIZE * 8};
+constexpr float MINI_REGION_TOP{CELL_SIZE * 7.5f};
+constexpr float MINI_REGION_HEIGHT{TARGET_HEIGHT - MINI_REGION_TOP - MINI_REGION_MARGIN};
+constexpr sf::Color MINI_ELIMINATED_COLOR{0, 0, 0, 176};
+
+static void writeRect(sf::Vertex *vertices, float posX, float posY, float width, float height, sf::Color color)
+{
+    const sf::Vector2f topLeft{posX, posY};
+    const sf::Vector2f topRight{posX + width, posY};
+    const sf::Vector2f bottomLeft{posX, posY + height};
+    const sf::Vector2f bottomRight{posX + width, posY + height};
+    vertices[0] = {topLeft, color, {}};
+    vertices[1] = {topRight, color, {}};
+    vertices[2] = {bottomLeft, color, {}};
+    vertices[3] = {bottomLeft, color, {}};
+    vertices[4] = {topRight, color, {}};
+    vertices[5] = {bottomRight, color, {}};
+}
+
+static void writeQuad(sf::Vertex *vertices, float posX, float posY, float size, sf::Color color)
+{
+    writeRect(vertices, posX, posY, size, size, color);
+}
+
+static void recolorQuad(sf::Vertex *vertices, sf::Color color)
+{
+    for (size_t i = 0; i < CELL_VERTEX_COUNT / 2; i++)
+        vertices[i].color = color;
+}
+
+// Mirrors a RectangleShape with an inner outline of RECTANGLE_OUTLINE_SIZE
+static void writeCell(sf::Vertex *vertices, float posX, float posY, float size, sf::Color fill, sf::Color outline)
+{
+    const float inset{-RECTANGLE_OUTLINE_SIZE};
+    writeQuad(vertices, posX, posY, size, outline);
+    writeQuad(vertices + CELL_VERTEX_COUNT / 2, posX + inset, posY + inset, size - 2 * inset, fill);
+}
+
+// Collapses every vertex of a cell onto one point, so an empty cell rasterizes nothing
+static void clearCell(sf::Vertex *vertices)
+{
+    std::fill(vertices, vertices + CELL_VERTEX_COUNT, sf::Vertex{});
+}
+
+Render::Render(sf::RenderWindow &_window, sf::Font &_roboto)
+    : startX((TARGET_WIDTH - TOTAL_GRID_WIDTH) / 2.0f),
+      startY((TARGET_HEIGHT - TOTAL_GRID_HEIGHT) / 2.0f),
+      window(_window),
+      roboto(_roboto)
 {
-    const float previewBoxX{startX + GRID_WIDTH * CELL_SIZE - CELL_SIZE * 19};
-    const float previewBoxY{startY + CELL_SIZE * 5};
-    const float previewBoxSize{CELL_SIZE * 6};
+    // An impossible color forces every cell to be written on the first frame
+    for (auto &row : drawnColors)
+        row.fill(TRANSPARENT);
+}
 
-    auto boxBg{sf::RectangleShape({previewBoxSize, previewBoxSize})};
+void Render::appendCell(float posX, float posY, Color color, bool outlined, float size)
+{
+    const size_t first{pieceCells.getVertexCount()};
+    if (outlined)
+    {
+        pieceCells.resize(first + CELL_VERTEX_COUNT);
+        writeCell(&pieceCells[first], posX, posY, size, enumToColor(color), enumToColor(DARK_PURPLE));
+    }
+    else
+    {
+        pieceCells.resize(first + CELL_VERTEX_COUNT / 2);
+        writeQuad(&pieceCells[first], posX, posY, size, enumToColor(color));
+    }
+}
+
+void Render::drawPreviewFrame(sf::RenderTarget &target, std::string_view title, float previewBoxX, float previewBoxY)
+{
+    auto boxBg{sf::RectangleShape({PREVIEW_BOX_SIZE, PREVIEW_BOX_SIZE})};
     boxBg.setPosition({previewBoxX, previewBoxY});
     boxBg.setFillColor(enumToColor(EMPTY));
     boxBg.setOutlineColor(sf::Color::White);
     boxBg.setOutlineThickness(3.0f);
-    window.draw(boxBg);
+    target.draw(boxBg);
 
-    auto label{sf::Text(roboto, "HOLD", 36)};
+    auto label{sf::Text(roboto, std::string(title), 36)};
     label.setPosition({previewBoxX + 75, previewBoxY - 50});
-    window.draw(label);
+    target.draw(label);
+}
 
-    auto rectangle{sf::RectangleShape({COLOR_SIZE, COLOR_SIZE})};
+void Render::drawPreviewBox(float previewBoxX, float previewBoxY, const Tetromino &tetromino)
+{
+    const float pieceWidth{tetromino.squareSize() * CELL_SIZE};
+    const float pieceHeight{tetromino.squareSize() * CELL_SIZE};
 
-    const float pieceWidth{tetromino.squareSize * CELL_SIZE};
-    const float pieceHeight{tetromino.squareSize * CELL_SIZE};
+    const float offsetX{previewBoxX + (PREVIEW_BOX_SIZE - pieceWidth) / 2.0f};
+    const float offsetYDenominator{(tetromino.type != PieceType::O) ? 1.5f : 2.0f};
+    const float offsetY{previewBoxY + (PREVIEW_BOX_SIZE - pieceHeight) / offsetYDenominator};
 
-    const float offsetX{previewBoxX + (previewBoxSize - pieceWidth) / 2.0f};
-    const float offsetYDenominator{(tetromino.id != 'O') ? 1.5f : 2.0f};
-    const float offsetY{previewBoxY + (previewBoxSize - pieceHeight) / offsetYDenominator};
+    for (int i = 0; i < tetromino.squareSize(); i++)
+    {
+        for (int j = 0; j < tetromino.squareSize(); j++)
+        {
+            if (!tetromino.isFilled(i, j))
+                continue;
+            appendCell(offsetX + j * CELL_SIZE, offsetY + i * CELL_SIZE, tetromino.color(), true);
+        }
+    }
+}
 
-    for (int i = 0; i < tetromino.squareSize; i++)
+void Render::drawHeldTetromino(const Tetromino &tetromino)
+{
+    TRACE_SCOPE("Render::drawHeldTetromino");
+    drawPreviewBox(holdBoxX(), previewBoxY(), tetromino);
+}
+
+// Centers the filled cells of the piece's spawn orientation in a slot of the queue column
+void Render::drawQueuedPiece(float slotX, float slotY, const Tetromino &tetromino)
+{
+    int firstRow{4}, lastRow{-1}, firstColumn{4}, lastColumn{-1};
+    for (int i = 0; i < tetromino.squareSize(); i++)
     {
-        for (int j = 0; j < tetromino.squareSize; j++)
+        for (int j = 0; j < tetromino.squareSize(); j++)
         {
-            if (tetromino.piece[i][j] == EMPTY)
+            if (!tetromino.isFilled(i, j))
                 continue;
-            const float posX{offsetX + j * CELL_SIZE};
-            const float posY{offsetY + i * CELL_SIZE};
-
-            rectangle.setPosition({posX, posY});
-            rectangle.setFillColor(enumToColor(tetromino.color));
-            rectangle.setOutlineThickness(RECTANGLE_OUTLINE_SIZE);
-            rectangle.setOutlineColor(enumToColor(DARK_PURPLE));
-            window.draw(rectangle);
+            firstRow = std::min(firstRow, i);
+            lastRow = std::max(lastRow, i);
+            firstColumn = std::min(firstColumn, j);
+            lastColumn = std::max(lastColumn, j);
+        }
+    }
+    const float offsetX{slotX + (PREVIEW_BOX_SIZE - (lastColumn - firstColumn + 1) * QUEUE_CELL_SIZE) / 2.0f - firstColumn * QUEUE_CELL_SIZE};
+    const float offsetY{slotY + (QUEUE_SLOT_HEIGHT - (lastRow - firstRow + 1) * QUEUE_CELL_SIZE) / 2.0f - firstRow * QUEUE_CELL_SIZE};
+    for (int i = firstRow; i <= lastRow; i++)
+    {
+        for (int j = firstColumn; j <= lastColumn; j++)
+        {
+            if (tetromino.isFilled(i, j))
+                appendCell(offsetX + j * QUEUE_CELL_SIZE, offsetY + i * QUEUE_CELL_SIZE, tetromino.color(), true, QUEUE_COLOR_SIZE);
         }
     }
 }
 
-void Render::drawTetromino(const Tetromino &tetromino)
+void Render::drawNextTetromino(const PieceQueue &queue)
 {
-    auto rectangle{sf::RectangleShape({COLOR_SIZE, COLOR_SIZE})};
-    for (int i = 0; i < tetromino.squareSize; i++)
+    TRACE_SCOPE("Render::drawNextTetromino");
+    const uint8_t shown{std::min(previewCount, queue.size())};
+    if (shown == 0)
+        return;
+    drawPreviewBox(nextBoxX(), previewBoxY(), queue[0]);
+    for (uint8_t i = 1; i < shown; i++)
+        drawQueuedPiece(nextBoxX(), previewBoxY() + PREVIEW_BOX_SIZE + (i - 1) * QUEUE_SLOT_HEIGHT, queue[i]);
+}
+
+void Render::drawTetromino(const Tetromino &tetromino, bool ghost, float offsetY)
+{
+    TRACE_SCOPE("Render::drawTetromino");
+    const Color color{ghost ? TRANSPARENT : tetromino.color()};
+    for (int i = 0; i < tetromino.squareSize(); i++)
     {
-        for (int j = 0; j < tetromino.squareSize; j++)
+        for (int j = 0; j < tetromino.squareSize(); j++)
         {
-            if (tetromino.piece[i][j] == EMPTY || tetromino.pos.y + i < 0)
+            if (!tetromino.isFilled(i, j) || tetromino.pos.y + i < 0)
                 continue;
             const float posX{startX + (tetromino.pos.x + j) * CELL_SIZE};
-            const float posY{startY + (tetromino.pos.y + i) * CELL_SIZE};
-            rectangle.setPosition({posX, posY});
-            rectangle.setFillColor(enumToColor(tetromino.color));
-            if (tetromino.color != TRANSPARENT)
-            {
-                rectangle.setOutlineThickness(RECTANGLE_OUTLINE_SIZE);
-                rectangle.setOutlineColor(enumToColor(DARK_PURPLE));
-            }
+            const float posY{startY + (tetromino.pos.y + i + offsetY) * CELL_SIZE};
+            appendCell(posX, posY, color, !ghost);
+        }
+    }
+}
+
+void Render::drawPieces()
+{
+    TRACE_SCOPE("Render::drawPieces");
+    window.draw(pieceCells);
+    pieceCells.clear();
+}
+
+void Render::buildStaticLayer()
+{
+    if (!staticLayer.resize({TARGET_WIDTH, TARGET_HEIGHT}))
+    {
+        throw std::runtime_error("Failed to create the static render layer.\n");
+    }
+    staticLayer.clear(BACKGROUND_COLOR);
+
+    auto gridBg{sf::RectangleShape({TOTAL_GRID_WIDTH, TOTAL_GRID_HEIGHT})};
+    gridBg.setPosition({startX, startY});
+    gridBg.setFillColor(enumToColor(EMPTY));
+    gridBg.setOutlineColor(sf::Color::White);
+    gridBg.setOutlineThickness(3.0f);
+    staticLayer.draw(gridBg);
+
+    drawPreviewFrame(staticLayer, "HOLD", holdBoxX(), previewBoxY());
+    if (previewCount > 1)
+    {
+        auto queueBg{sf::RectangleShape({PREVIEW_BOX_SIZE, (previewCount - 1) * QUEUE_SLOT_HEIGHT})};
+        queueBg.setPosition({nextBoxX(), previewBoxY() + PREVIEW_BOX_SIZE});
+        queueBg.setFillColor(enumToColor(EMPTY));
+        queueBg.setOutlineColor(sf::Color::White);
+        queueBg.setOutlineThickness(3.0f);
+        staticLayer.draw(queueBg);
+    }
+    drawPreviewFrame(staticLayer, "NEXT", nextBoxX(), previewBoxY());
+    staticLayer.display();
+    staticSprite.emplace(staticLayer.getTexture());
+
+    textLevel.setPosition({startX - GRID_WIDTH * CELL_SIZE, startY});
+    textScore.setPosition({startX + GRID_WIDTH * CELL_SIZE + CELL_SIZE * 2, startY});
+    textFrameStats.setPosition({CELL_SIZE / 2, CELL_SIZE / 2});
+    textPractice.setPosition({CELL_SIZE / 2, TARGET_HEIGHT - CELL_SIZE * 1.5f});
+    textAutoplay.setPosition({CELL_SIZE / 2, TARGET_HEIGHT - CELL_SIZE * 2.5f});
 
-            window.draw(rectangle);
+    // Rasterize the HUD glyphs now so the first score change does not stall a frame
+    for (const char glyph : std::string_view{"0123456789Score: Level"})
+        roboto.getGlyph(static_cast<unsigned char>(glyph), textScore.getCharacterSize(), false);
+}
+
+void Render::drawStaticLayer()
+{
+    TRACE_SCOPE("Render::drawStaticLayer");
+    window.draw(*staticSprite);
+}
+
+void Render::drawStats(int score, unsigned int level, uint32_t revision)
+{
+    TRACE_SCOPE("Render::drawStats");
+    if (statsRevision != revision)
+    {
+        textScore.setString("Score: " + std::to_string(score));
+        textLevel.setString("Level " + std::to_string(level));
+        statsRevision = revision;
+    }
+    window.draw(textLevel);
+    window.draw(textScore);
+}
+
+void Render::drawFrameStats(float p50, float p99)
+{
+    TRACE_SCOPE("Render::drawFrameStats");
+    if (shownFrameStats != std::make_pair(p50, p99))
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "frame p50 %.2f ms  p99 %.2f ms", p50, p99);
+        textFrameStats.setString(text);
+        shownFrameStats = std::make_pair(p50, p99);
+    }
+    window.draw(textFrameStats);
+}
+
+void Render::drawPracticeMode(bool rewinding)
+{
+    TRACE_SCOPE("Render::drawPracticeMode");
+    textPractice.setString(rewinding ? "PRACTICE  rewinding" : "PRACTICE  hold Backspace to rewind");
+    window.draw(textPractice);
+}
+
+void Render::drawAutoplay(uint16_t width, uint8_t depth)
+{
+    TRACE_SCOPE("Render::drawAutoplay");
+    if (shownAutoplay != std::make_pair(width, depth))
+    {
+        char text[64];
+        std::snprintf(text, sizeof(text), "AUTOPLAY  beam %u x %u  F6 to take over", static_cast<unsigned>(width), static_cast<unsigned>(depth));
+        textAutoplay.setString(text);
+        shownAutoplay = std::make_pair(width, depth);
+    }
+    window.draw(textAutoplay);
+}
+
+void Render::drawOpponent(const Board &board, uint8_t garbagePending)
+{
+    TRACE_SCOPE("Render::drawOpponent");
+    // Under the HOLD box, since the queue fills the column under NEXT
+    const float cellSize{OPPONENT_CELL_SIZE};
+    const float originX{holdBoxX() + (PREVIEW_BOX_SIZE - GRID_WIDTH * cellSize) / 2.0f};
+    const float originY{previewBoxY() + PREVIEW_BOX_SIZE + CELL_SIZE * 2};
+
+    opponentCells.clear();
+    const auto appendQuad{[this](float posX, float posY, float width, float height, sf::Color color)
+                          {
+                              const size_t first{opponentCells.getVertexCount()};
+                              opponentCells.resize(first + CELL_VERTEX_COUNT / 2);
+                              sf::Vertex *vertices{&opponentCells[first]};
+                              vertices[0] = {{posX, posY}, color, {}};
+                              vertices[1] = {{posX + width, posY}, color, {}};
+                              vertices[2] = {{posX, posY + height}, color, {}};
+                              vertices[3] = {{posX, posY + height}, color, {}};
+                              vertices[4] = {{posX + width, posY}, color, {}};
+                              vertices[5] = {{posX + width, posY + height}, color, {}};
+                          }};
+    appendQuad(originX, originY, GRID_WIDTH * cellSize, GRID_HEIGHT * cellSize, enumToColor(EMPTY));
+    for (int i = 0; i < GRID_HEIGHT; i++)
+    {
+        for (int j = 0; j < GRID_WIDTH; j++)
+        {
+            if (board.colorRow(i)[j] != EMPTY)
+                appendQuad(originX + j * cellSize, originY + i * cellSize, cellSize, cellSize, enumToColor(board.colorRow(i)[j]));
         }
     }
+    const float garbageHeight{std::min<float>(garbagePending, GRID_HEIGHT) * cellSize};
+    appendQuad(originX - cellSize / 2, originY + GRID_HEIGHT * cellSize - garbageHeight, cellSize / 2, garbageHeight, sf::Color::Red);
+    window.draw(opponentCells);
 }
 
-void Render::drawNextTetromino(const Tetromino &tetromino)
+void Render::drawGarbageMeter(uint8_t lines)
 {
-    const float previewBoxX{startX + GRID_WIDTH * CELL_SIZE + CELL_SIZE * 3};
-    const float previewBoxY{startY + CELL_SIZE * 5};
-    const float previewBoxSize{CELL_SIZE * 6};
+    TRACE_SCOPE("Render::drawGarbageMeter");
+    const float height{std::min<float>(lines, GRID_HEIGHT) * CELL_SIZE};
+    auto meter{sf::RectangleShape({CELL_SIZE / 4, height})};
+    meter.setPosition({startX - CELL_SIZE / 2, startY + TOTAL_GRID_HEIGHT - height});
+    meter.setFillColor(sf::Color::Red);
+    window.draw(meter);
+}
 
-    auto boxBg{sf::RectangleShape({previewBoxSize, previewBoxSize})};
-    boxBg.setPosition({previewBoxX, previewBoxY});
-    boxBg.setFillColor(enumToColor(EMPTY));
-    boxBg.setOutlineColor(sf::Color::White);
-    boxBg.setOutlineThickness(3.0f);
-    window.draw(boxBg);
+void Render::drawMessage(std::string_view text)
+{
+    TRACE_SCOPE("Render::drawMessage");
+    textMessage.setString(std::string(text));
+    const sf::FloatRect bounds{textMessage.getLocalBounds()};
+    textMessage.setPosition({startX + (TOTAL_GRID_WIDTH - bounds.size.x) / 2 - bounds.position.x, startY + TOTAL_GRID_HEIGHT / 3});
+    window.draw(textMessage);
+}
 
-    auto label{sf::Text(roboto, "NEXT", 36)};
-    label.setPosition({previewBoxX + 75, previewBoxY - 50});
-    window.draw(label);
+// Each side holds half of the boards in a grid of the largest cell size at which
+// they all fit, with a cell of space between boards
+void Render::layoutMiniBoards(size_t count)
+{
+    const size_t perSide{(count + 1) / 2};
+    float cellSize{};
+    size_t columns{1};
+    for (size_t tryColumns = 1; tryColumns <= perSide; tryColumns++)
+    {
+        const size_t rows{(perSide + tryColumns - 1) / tryColumns};
+        const float fitting{std::min(MINI_REGION_WIDTH / (tryColumns * (GRID_WIDTH + 1)), MINI_REGION_HEIGHT / (rows * (GRID_HEIGHT + 1)))};
+        if (fitting > cellSize)
+        {
+            cellSize = fitting;
+            columns = tryColumns;
+        }
+    }
+    cellSize = std::max(1.0f, std::floor(cellSize));
 
-    auto rectangle{sf::RectangleShape({COLOR_SIZE, COLOR_SIZE})};
+    miniVertices.resize(count * MINI_BOARD_VERTEX_COUNT);
+    for (size_t board = 0; board < count; board++)
+    {
+        const size_t slot{board < perSide ? board : board - perSide};
+        const float regionX{board < perSide ? MINI_REGION_MARGIN : TARGET_WIDTH - MINI_REGION_MARGIN - MINI_REGION_WIDTH};
+        const float originX{regionX + (slot % columns) * (GRID_WIDTH + 1) * cellSize};
+        const float originY{MINI_REGION_TOP + (slot / columns) * (GRID_HEIGHT + 1) * cellSize};
+        sf::Vertex *segment{&miniVertices[board * MINI_BOARD_VERTEX_COUNT]};
+        for (int i = 0; i < GRID_HEIGHT; i++)
+        {
+            for (int j = 0; j < GRID_WIDTH; j++)
+                writeQuad(segment + (i * GRID_WIDTH + j) * CELL_VERTEX_COUNT / 2, originX + j * cellSize, originY + i * cellSize, cellSize, enumToColor(EMPTY));
+        }
+        writeRect(segment + GRID_WIDTH * GRID_HEIGHT * CELL_VERTEX_COUNT / 2, originX, originY, GRID_WIDTH * cellSize, GRID_HEIGHT * cellSize, sf::Color::Transparent);
+    }
 
-    const float pieceWidth{tetromino.squareSize * CELL_SIZE};
-    const float pieceHeight{tetromino.squareSize * CELL_SIZE};
+    // Impossible values force every cell and overlay to be written on the next draw
+    std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT> unknown;
+    for (auto &row : unknown)
+        row.fill(TRANSPARENT);
+    miniColors.assign(count, unknown);
+    miniEliminated.assign(count, UINT8_MAX);
 
-    const float offsetX{previewBoxX + (previewBoxSize - pieceWidth) / 2.0f};
-    const float offsetYDenominator{(tetromino.id != 'O') ? 1.5f : 2.0f};
-    const float offsetY{previewBoxY + (previewBoxSize - pieceHeight) / offsetYDenominator};
+    miniBuffered = sf::VertexBuffer::isAvailable() && miniBuffer.create(miniVertices.size()) && miniBuffer.update(miniVertices.data());
+}
+
+void Render::drawMiniBoards(const std::vector<Board> &boards, const std::vector<uint8_t> &eliminated)
+{
+    TRACE_SCOPE("Render::drawMiniBoards");
+    if (miniColors.size() != boards.size())
+        layoutMiniBoards(boards.size());
 
-    for (int i = 0; i < tetromino.squareSize; i++)
+    std::optional<size_t> runStart;
+    const auto upload{[this, &runStart](size_t runEnd)
+                      {
+                          if (miniBuffered && runStart)
+                          {
+                              const size_t first{*runStart * MINI_BOARD_VERTEX_COUNT};
+                              miniBuffer.update(&miniVertices[first], (runEnd - *runStart) * MINI_BOARD_VERTEX_COUNT, static_cast<unsigned>(first));
+                          }
+                          runStart.reset();
+                      }};
+    for (size_t board = 0; board < boards.size(); board++)
     {
-        for (int j = 0; j < tetromino.squareSize; j++)
+        sf::Vertex *segment{&miniVertices[board * MINI_BOARD_VERTEX_COUNT]};
+        bool changed{false};
+        for (int i = 0; i < GRID_HEIGHT; i++)
         {
-            if (tetromino.piece[i][j] == EMPTY)
+            if (miniColors[board][i] == boards[board].colorRow(i))
                 continue;
-            const float posX{offsetX + j * CELL_SIZE};
-            const float posY{offsetY + i * CELL_SIZE};
-
-            rectangle.setPosition({posX, posY});
-            rectangle.setFillColor(enumToColor(tetromino.color));
-            rectangle.setOutlineThickness(RECTANGLE_OUTLINE_SIZE);
-            rectangle.setOutlineColor(enumToColor(DARK_PURPLE));
-            window.draw(rectangle);
+            for (int j = 0; j < GRID_WIDTH; j++)
+            {
+                const Color color{boards[board].colorRow(i)[j]};
+                if (miniColors[board][i][j] == color)
+                    continue;
+                recolorQuad(segment + (i * GRID_WIDTH + j) * CELL_VERTEX_COUNT / 2, enumToColor(color));
+                miniColors[board][i][j] = color;
+            }
+            changed = true;
+        }
+        if (miniEliminated[board] != eliminated[board])
+        {
+            recolorQuad(segment + GRID_WIDTH * GRID_HEIGHT * CELL_VERTEX_COUNT / 2, eliminated[board] ? MINI_ELIMINATED_COLOR : sf::Color::Transparent);
+            miniEliminated[board] = eliminated[board];
+            changed = true;
         }
+
+        if (changed && !runStart)
+            runStart = board;
+        else if (!changed)
+            upload(board);
     }
+    upload(boards.size());
+
+    if (miniBuffered)
+        window.draw(miniBuffer);
+    else
+        window.draw(miniVertices.data(), miniVertices.size(), sf::PrimitiveType::Triangles);
 }
 
-void Render::drawText(sf::Text &text, std::string content, float posX, float posY)
+void Render::drawSurvivors(uint8_t survivors, uint8_t players)
 {
-    text.setPosition({posX, posY});
-    text.setString(content);
-    window.draw(text);
+    TRACE_SCOPE("Render::drawSurvivors");
+    if (shownSurvivors != std::make_pair(survivors, players))
+    {
+        textSurvivors.setString(std::to_string(survivors) + " / " + std::to_string(players) + " left");
+        const sf::FloatRect bounds{textSurvivors.getLocalBounds()};
+        textSurvivors.setPosition({startX + (TOTAL_GRID_WIDTH - bounds.size.x) / 2 - bounds.position.x, startY + TOTAL_GRID_HEIGHT + CELL_SIZE / 2});
+        shownSurvivors = std::make_pair(survivors, players);
+    }
+    window.draw(textSurvivors);
 }
 
-void Render::drawGrid(std::array<std::array<Color, GRID_WIDTH>, GRID_HEIGHT> screenState)
+void Render::drawLoadingScreen(float progress)
 {
-    constexpr float TOTAL_GRID_WIDTH{GRID_WIDTH * CELL_SIZE};
-    constexpr float TOTAL_GRID_HEIGHT{GRID_HEIGHT * CELL_SIZE};
-
-    static const float START_X{(TARGET_WIDTH - TOTAL_GRID_WIDTH) / 2.0f};
-    static const float START_Y{(TARGET_HEIGHT - TOTAL_GRID_HEIGHT) / 2.0f};
+    constexpr float barWidth{TARGET_WIDTH / 3.0f};
+    constexpr float barHeight{CELL_SIZE / 2.0f};
 
-    startX = START_X;
-    startY = START_Y;
+    auto frame{sf::RectangleShape({barWidth, barHeight})};
+    frame.setPosition({(TARGET_WIDTH - barWidth) / 2.0f, (TARGET_HEIGHT - barHeight) / 2.0f});
+    frame.setFillColor(enumToColor(EMPTY));
+    frame.setOutlineColor(sf::Color::White);
+    frame.setOutlineThickness(3.0f);
+    window.draw(frame);
 
-    auto gridBg{sf::RectangleShape({TOTAL_GRID_WIDTH, TOTAL_GRID_HEIGHT})};
-    gridBg.setPosition({START_X, START_Y});
-    gridBg.setFillColor(enumToColor(EMPTY));
-    gridBg.setOutlineColor(sf::Color::White);
-    gridBg.setOutlineThickness(3.0f);
-    window.draw(gridBg);
+    auto bar{sf::RectangleShape({barWidth * std::clamp(progress, 0.0f, 1.0f), barHeight})};
+    bar.setPosition(frame.getPosition());
+    bar.setFillColor(enumToColor(CYAN));
+    window.draw(bar);
+}
 
-    auto rectangle{sf::RectangleShape({COLOR_SIZE, COLOR_SIZE})};
+void Render::drawGrid(const Board &board)
+{
+    TRACE_SCOPE("Render::drawGrid");
     for (int i = 0; i < GRID_HEIGHT; i++)
     {
         for (int j = 0; j < GRID_WIDTH; j++)
         {
-            if (screenState[i][j] == EMPTY)
+            const Color color{board.colorRow(i)[j]};
+            if (drawnColors[i][j] == color)
                 continue;
-            const float posX{START_X + j * CELL_SIZE};
-            const float posY{START_Y + i * CELL_SIZE};
-
-            rectangle.setPosition({posX, posY});
-            rectangle.setFillColor(enumToColor(screenState[i][j]));
-            rectangle.setOutlineThickness(RECTANGLE_OUTLINE_SIZE);
-            rectangle.setOutlineColor(enumToColor(DARK_PURPLE));
-            window.draw(rectangle);
+            drawnColors[i][j] = color;
+
+            sf::Vertex *cell{&boardCells[(i * GRID_WIDTH + j) * CELL_VERTEX_COUNT]};
+            if (color == EMPTY)
+                clearCell(cell);
+            else
+                writeCell(cell, startX + j * CELL_SIZE, startY + i * CELL_SIZE, COLOR_SIZE, enumToColor(color), enumToColor(DARK_PURPLE));
         }
     }
-}
\ No newline at end of file
+    window.draw(boardCells);
+}
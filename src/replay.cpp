@@ -0,0 +1,129 @@
+#include "replay.hpp"
+#include <fstream>
+#include <stdexcept>
+
+constexpr uint8_t ACTION_BITS{3};
+
+static void writeVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void ReplayWriter::record(uint64_t tick, Action action)
+{
+    writeVarint(records, ((tick - lastTick) << ACTION_BITS) | static_cast<uint8_t>(action));
+    lastTick = tick;
+    recordCount++;
+}
+
+std::vector<uint8_t> ReplayWriter::serialize(const Simulation &simulation) const
+{
+    std::vector<uint8_t> out(REPLAY_MAGIC.begin(), REPLAY_MAGIC.end());
+    out.push_back(REPLAY_VERSION);
+    out.push_back(static_cast<uint8_t>(mode));
+    writeVarint(out, TICK_RATE);
+    writeVarint(out, seed);
+    writeVarint(out, recordCount);
+    writeVarint(out, simulation.getTickCount());
+    writeVarint(out, simulation.getGameManager().getScore());
+    writeVarint(out, simulation.getPiecesPlaced());
+    out.insert(out.end(), records.begin(), records.end());
+    return out;
+}
+
+void ReplayWriter::save(const std::filesystem::path &path, const Simulation &simulation) const
+{
+    const std::vector<uint8_t> bytes{serialize(simulation)};
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size()))
+    {
+        throw std::runtime_error("Failed to save replay " + path.string() + ".\n");
+    }
+}
+
+ReplayReader::ReplayReader(const uint8_t *data, size_t size) : cursor(data), end(data + size)
+{
+    if (size < REPLAY_MAGIC.size() + 2 || !std::equal(REPLAY_MAGIC.begin(), REPLAY_MAGIC.end(), data))
+    {
+        throw std::runtime_error("Not a replay file.\n");
+    }
+    cursor += REPLAY_MAGIC.size();
+    if (*cursor++ != REPLAY_VERSION)
+    {
+        throw std::runtime_error("Unsupported replay version.\n");
+    }
+    header.mode = static_cast<RandomizerMode>(*cursor++);
+    if (readVarint() != TICK_RATE)
+    {
+        throw std::runtime_error("Replay was recorded at a different tick rate.\n");
+    }
+    header.seed = readVarint();
+    header.recordCount = readVarint();
+    header.finalTick = readVarint();
+    header.finalScore = readVarint();
+    header.piecesPlaced = readVarint();
+    recordsLeft = header.recordCount;
+}
+
+uint64_t ReplayReader::readVarint()
+{
+    uint64_t value{};
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (cursor == end)
+        {
+            throw std::runtime_error("Truncated replay file.\n");
+        }
+        const uint8_t byte{*cursor++};
+        value |= uint64_t{byte & 0x7Fu} << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    throw std::runtime_error("Malformed varint in replay file.\n");
+}
+
+bool ReplayReader::next(ReplayEvent &event)
+{
+    if (recordsLeft == 0)
+        return false;
+    recordsLeft--;
+
+    const uint64_t record{readVarint()};
+    tick += record >> ACTION_BITS;
+    event.tick = tick;
+    event.action = static_cast<Action>(record & ((1u << ACTION_BITS) - 1));
+    return true;
+}
+
+Simulation playReplay(ReplayReader &reader)
+{
+    const ReplayHeader &header{reader.getHeader()};
+    Simulation simulation{header.seed, header.mode};
+
+    ReplayEvent event;
+    while (reader.next(event))
+    {
+        while (simulation.getTickCount() < event.tick)
+            simulation.tick();
+        simulation.apply(event.action);
+    }
+    while (simulation.getTickCount() < header.finalTick)
+        simulation.tick();
+    return simulation;
+}
+
+bool verifyReplay(ReplayReader &reader)
+{
+    const Simulation simulation{playReplay(reader)};
+    const ReplayHeader &header{reader.getHeader()};
+    return static_cast<uint64_t>(simulation.getGameManager().getScore()) == header.finalScore &&
+           simulation.getPiecesPlaced() == header.piecesPlaced;
+}
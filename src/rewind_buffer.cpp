@@ -0,0 +1,21 @@
+#include "rewind_buffer.hpp"
+#include <algorithm>
+
+RewindBuffer::RewindBuffer(size_t capacity) : states(std::max<size_t>(capacity, 1)) {}
+
+void RewindBuffer::push(const GameState &state)
+{
+    states[next] = state;
+    next = (next + 1) % states.size();
+    count = std::min(count + 1, states.size());
+}
+
+bool RewindBuffer::pop(GameState &state)
+{
+    if (count == 0)
+        return false;
+    next = (next + states.size() - 1) % states.size();
+    state = states[next];
+    count--;
+    return true;
+}
@@ -0,0 +1,88 @@
+#include "rollback.hpp"
+#include "trace.hpp"
+
+RollbackSession::RollbackSession(uint8_t _localPlayer, uint64_t seed, const std::array<InputSettings, VERSUS_PLAYERS> &settings)
+    : localPlayer(_localPlayer), match(seed, settings)
+{
+    checksums[0] = versusChecksum(match.snapshot());
+}
+
+uint8_t RollbackSession::predictedRemote() const
+{
+    return remoteConfirmed > 0 ? inputs[remotePlayer()][(remoteConfirmed - 1) % INPUT_HISTORY] : 0;
+}
+
+// Simulates the current tick from the stored inputs, predicting the remote ones not yet confirmed
+void RollbackSession::step(bool resimulating)
+{
+    snapshots[tick % SNAPSHOT_HISTORY] = match.snapshot();
+    if (tick >= remoteConfirmed)
+        inputs[remotePlayer()][tick % INPUT_HISTORY] = predictedRemote();
+
+    std::array<uint8_t, VERSUS_PLAYERS> held{};
+    for (uint8_t i = 0; i < VERSUS_PLAYERS; i++)
+        held[i] = inputs[i][tick % INPUT_HISTORY];
+    const std::array<uint8_t, VERSUS_PLAYERS> events{match.advance(held)};
+    if (!resimulating)
+        localEvents = events[localPlayer];
+    tick++;
+}
+
+uint8_t RollbackSession::advance(uint8_t localHeld)
+{
+    inputs[localPlayer][tick % INPUT_HISTORY] = localHeld;
+    step(false);
+    recordChecksums();
+    return localEvents;
+}
+
+void RollbackSession::receiveRemote(uint32_t remoteTick, uint8_t held)
+{
+    // Further ahead than the remote may run would overwrite inputs a rollback still needs
+    if (remoteTick != remoteConfirmed || remoteTick >= tick + INPUT_HISTORY - MAX_ROLLBACK_TICKS)
+        return;
+    uint8_t &stored{inputs[remotePlayer()][remoteTick % INPUT_HISTORY]};
+    if (remoteTick < tick && stored != held && (!rollbackFrom || remoteTick < *rollbackFrom))
+        rollbackFrom = remoteTick;
+    stored = held;
+    remoteConfirmed++;
+}
+
+void RollbackSession::resolve()
+{
+    if (rollbackFrom)
+    {
+        TRACE_SCOPE("RollbackSession::rollback");
+        const uint32_t target{tick};
+        const uint32_t depth{target - *rollbackFrom};
+        match.restore(snapshots[*rollbackFrom % SNAPSHOT_HISTORY]);
+        tick = *rollbackFrom;
+        while (tick < target)
+            step(true);
+        rollbackFrom.reset();
+
+        stats.rollbacks++;
+        stats.resimulatedTicks += depth;
+        stats.deepestRollback = std::max(stats.deepestRollback, depth);
+    }
+    recordChecksums();
+}
+
+// A tick's starting state is final once every remote input before it is confirmed
+void RollbackSession::recordChecksums()
+{
+    const uint32_t confirmedTo{std::min(remoteConfirmed, tick)};
+    for (uint32_t checksumTick = checksummedTo + 1; checksumTick <= confirmedTo; checksumTick++)
+    {
+        const VersusState state{checksumTick == tick ? match.snapshot() : snapshots[checksumTick % SNAPSHOT_HISTORY]};
+        checksums[checksumTick % SNAPSHOT_HISTORY] = versusChecksum(state);
+    }
+    checksummedTo = std::max(checksummedTo, confirmedTo);
+}
+
+std::optional<uint64_t> RollbackSession::getChecksum(uint32_t checksumTick) const
+{
+    if (checksumTick > checksummedTo || checksummedTo - checksumTick >= SNAPSHOT_HISTORY)
+        return std::nullopt;
+    return checksums[checksumTick % SNAPSHOT_HISTORY];
+}
@@ -0,0 +1,403 @@
+#include "beam_bot.hpp"
+#include "mapped_file.hpp"
+#include "replay.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    enum class SimPlayer
+    {
+        RANDOM,
+        GREEDY,
+        BEAM
+    };
+
+    struct SimOptions
+    {
+        uint64_t games{1000};
+        uint64_t maxPieces{10000};
+        uint64_t seed{1};
+        RandomizerMode randomizer{RandomizerMode::BAG_7};
+        std::string scriptPath;
+        std::string replayPath;
+        std::string recordDir;
+        uint8_t perftDepth{};
+        // Transposition table for perft, 0 to count every subtree in full
+        size_t hashMegabytes{64};
+        // Plays every piece with a bot instead of at random; the beam bot gets its own pool beyond one thread
+        SimPlayer player{SimPlayer::RANDOM};
+        BeamSettings beam;
+        unsigned threads{1};
+    };
+
+    // What the bot players report: the time each move took to decide, the beam searched for it, and each game's final score
+    struct BotStats
+    {
+        std::vector<float> moveMicros;
+        uint64_t beamDepth{};
+        uint64_t beamWidth{};
+        uint64_t score{};
+    };
+
+    // Script files use the game's key bindings, one action per tick:
+    // A/D move, S soft drop, H hard drop, W/Z rotate CCW/CW, C hold, R reset, '.' idle
+    std::vector<std::optional<Action>> loadScript(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open script " + path + ".\n");
+        }
+
+        std::vector<std::optional<Action>> script;
+        char c;
+        while (file.get(c))
+        {
+            switch (std::toupper(static_cast<unsigned char>(c)))
+            {
+            case 'A':
+                script.push_back(Action::MOVE_LEFT);
+                break;
+            case 'D':
+                script.push_back(Action::MOVE_RIGHT);
+                break;
+            case 'S':
+                script.push_back(Action::SOFT_DROP);
+                break;
+            case 'H':
+                script.push_back(Action::HARD_DROP);
+                break;
+            case 'W':
+                script.push_back(Action::ROTATE_CCW);
+                break;
+            case 'Z':
+                script.push_back(Action::ROTATE_CW);
+                break;
+            case 'C':
+                script.push_back(Action::HOLD);
+                break;
+            case 'R':
+                script.push_back(Action::RESET);
+                break;
+            case '.':
+                script.push_back(std::nullopt);
+                break;
+            default:
+                break;
+            }
+        }
+        return script;
+    }
+
+    RandomizerMode parseRandomizer(const std::string &name)
+    {
+        if (name == "bag7")
+            return RandomizerMode::BAG_7;
+        if (name == "bag14")
+            return RandomizerMode::BAG_14;
+        if (name == "random")
+            return RandomizerMode::RANDOM;
+        if (name == "history")
+            return RandomizerMode::HISTORY;
+        throw std::runtime_error("Unknown randomizer " + name + ".\n");
+    }
+
+    SimPlayer parsePlayer(const std::string &name)
+    {
+        if (name == "random")
+            return SimPlayer::RANDOM;
+        if (name == "greedy")
+            return SimPlayer::GREEDY;
+        if (name == "beam")
+            return SimPlayer::BEAM;
+        throw std::runtime_error("Unknown bot " + name + ".\n");
+    }
+
+    SimOptions parseOptions(int argc, char **argv)
+    {
+        SimOptions options;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg{argv[i]};
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + arg + ".\n");
+            }
+            const std::string value{argv[++i]};
+            if (arg == "--games")
+                options.games = std::stoull(value);
+            else if (arg == "--pieces")
+                options.maxPieces = std::stoull(value);
+            else if (arg == "--seed")
+                options.seed = std::stoull(value);
+            else if (arg == "--randomizer")
+                options.randomizer = parseRandomizer(value);
+            else if (arg == "--script")
+                options.scriptPath = value;
+            else if (arg == "--replay")
+                options.replayPath = value;
+            else if (arg == "--record")
+                options.recordDir = value;
+            else if (arg == "--perft")
+                options.perftDepth = static_cast<uint8_t>(std::stoul(value));
+            else if (arg == "--hash")
+                options.hashMegabytes = std::stoull(value);
+            else if (arg == "--bot")
+                options.player = parsePlayer(value);
+            else if (arg == "--budget")
+                options.beam.budget = std::chrono::microseconds(std::stoull(value));
+            else if (arg == "--width")
+                options.beam.width = static_cast<uint16_t>(std::clamp<unsigned long>(std::stoul(value), 1, UINT16_MAX));
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            else
+                throw std::runtime_error("Unknown option " + arg + ".\n");
+        }
+        return options;
+    }
+
+    uint8_t applyAction(Simulation &simulation, ReplayWriter *writer, Action action)
+    {
+        if (writer)
+            writer->record(simulation.getTickCount(), action);
+        return simulation.apply(action);
+    }
+
+    // Random player: picks a rotation and a column for every piece and hard drops it
+    void playRandomGame(Simulation &simulation, ReplayWriter *writer, Xoshiro256 &rng, uint64_t maxPieces)
+    {
+        for (uint64_t piece = 0; piece < maxPieces; piece++)
+        {
+            for (int r = rng.below(4); r > 0; r--)
+                applyAction(simulation, writer, Action::ROTATE_CW);
+            const int shift{static_cast<int>(rng.below(11)) - 5};
+            for (int s = 0; s < std::abs(shift); s++)
+                applyAction(simulation, writer, shift < 0 ? Action::MOVE_LEFT : Action::MOVE_RIGHT);
+            simulation.tick();
+            if (applyAction(simulation, writer, Action::HARD_DROP) & EVENT_TOPPED_OUT)
+                break;
+        }
+    }
+
+    // Bot player: decides each piece where it spawned, timing the decision, and plays it out
+    template <typename Decide>
+    void playBotGame(Simulation &simulation, ReplayWriter *writer, uint64_t maxPieces, BotStats &stats, Decide decide)
+    {
+        std::vector<Action> path;
+        int score{};
+        for (uint64_t piece = 0; piece < maxPieces; piece++)
+        {
+            simulation.tick();
+            const auto start{std::chrono::steady_clock::now()};
+            decide(simulation, path);
+            stats.moveMicros.push_back(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+            if (path.empty())
+                path.push_back(Action::HARD_DROP);
+            uint8_t events{EVENT_NONE};
+            for (Action action : path)
+                events |= applyAction(simulation, writer, action);
+            // Topping out resets the score, so a game's score is the one before it
+            if (events & EVENT_TOPPED_OUT)
+                break;
+            score = simulation.getGameManager().getScore();
+        }
+        stats.score += static_cast<uint64_t>(score);
+    }
+
+    void playScriptedGame(Simulation &simulation, ReplayWriter *writer, const std::vector<std::optional<Action>> &script, uint64_t maxPieces)
+    {
+        for (const std::optional<Action> &action : script)
+        {
+            uint8_t events{simulation.tick()};
+            if (action)
+                events |= applyAction(simulation, writer, *action);
+            if ((events & EVENT_TOPPED_OUT) || simulation.getPiecesPlaced() >= maxPieces)
+                break;
+        }
+    }
+
+    // Counts placement sequences on an empty board for the seeded piece queue, depth by depth
+    void runPerft(const SimOptions &options)
+    {
+        GameManager gameManager{options.seed, options.randomizer};
+        std::vector<PieceType> queue;
+        while (queue.size() < options.perftDepth)
+        {
+            for (const Tetromino &tetromino : gameManager.generateBag())
+                queue.push_back(tetromino.type);
+        }
+
+        MoveGenerator generator;
+        std::optional<TranspositionTable> table;
+        if (options.hashMegabytes > 0)
+            table.emplace(options.hashMegabytes);
+        for (uint8_t depth = 1; depth <= options.perftDepth; depth++)
+        {
+            // Each depth starts from an empty table, so its time stands on its own
+            if (table)
+                table->clear();
+            const auto start{std::chrono::steady_clock::now()};
+            const uint64_t count{generator.perft(gameManager, queue, depth, table ? &*table : nullptr)};
+            const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+            std::cout << "perft(" << static_cast<int>(depth) << ") = " << count << "  " << elapsed.count() << " s  "
+                      << (elapsed.count() > 0 ? count / elapsed.count() : 0) << " placements/sec\n";
+        }
+    }
+
+    void reportBotStats(const SimOptions &options, BotStats &stats)
+    {
+        std::vector<float> &micros{stats.moveMicros};
+        std::sort(micros.begin(), micros.end());
+        const auto percentile = [&](double p) { return micros[static_cast<size_t>(p * static_cast<double>(micros.size() - 1))]; };
+        const double moves{static_cast<double>(micros.size())};
+        std::cout << "score/game: " << static_cast<double>(stats.score) / static_cast<double>(options.games) << '\n'
+                  << "move p50:   " << percentile(0.5) << " us\n"
+                  << "move p99:   " << percentile(0.99) << " us\n"
+                  << "move max:   " << micros.back() << " us\n";
+        if (options.player == SimPlayer::BEAM)
+        {
+            const float budget{static_cast<float>(options.beam.budget.count())};
+            const auto over{micros.end() - std::upper_bound(micros.begin(), micros.end(), budget)};
+            std::cout << "over budget: " << over << " (" << 100.0 * static_cast<double>(over) / moves << "%)\n"
+                      << "beam width: " << static_cast<double>(stats.beamWidth) / moves << '\n'
+                      << "beam depth: " << static_cast<double>(stats.beamDepth) / moves << '\n';
+        }
+    }
+
+    // Re-simulates every replay under path (a file or a directory) and checks the recorded outcome
+    int verifyReplays(const std::string &path)
+    {
+        std::vector<std::filesystem::path> files;
+        if (std::filesystem::is_directory(path))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(path))
+            {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path());
+            }
+        }
+        else
+        {
+            files.push_back(path);
+        }
+
+        uint64_t mismatches{};
+        uint64_t totalTicks{};
+        const auto start{std::chrono::steady_clock::now()};
+        for (const std::filesystem::path &file : files)
+        {
+            const MappedFile mapped(file);
+            ReplayReader reader(mapped.data(), mapped.size());
+            totalTicks += reader.getHeader().finalTick;
+            if (!verifyReplay(reader))
+            {
+                std::cout << "MISMATCH: " << file.string() << '\n';
+                mismatches++;
+            }
+        }
+        const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+        std::cout << "replays:    " << files.size() << '\n'
+                  << "mismatches: " << mismatches << '\n'
+                  << "ticks:      " << totalTicks << '\n'
+                  << "elapsed:    " << elapsed.count() << " s\n"
+                  << "ticks/sec:  " << (elapsed.count() > 0 ? totalTicks / elapsed.count() : 0) << '\n';
+        return mismatches == 0 ? 0 : 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const SimOptions options{parseOptions(argc, argv)};
+        if (!options.replayPath.empty())
+            return verifyReplays(options.replayPath);
+        if (options.perftDepth > 0)
+        {
+            runPerft(options);
+            return 0;
+        }
+
+        std::vector<std::optional<Action>> script;
+        if (!options.scriptPath.empty())
+            script = loadScript(options.scriptPath);
+
+        Xoshiro256 rng(options.seed);
+        uint64_t totalPieces{};
+        uint64_t totalTicks{};
+
+        Bot greedy;
+        std::optional<ThreadPool> pool;
+        if (options.player == SimPlayer::BEAM && options.threads > 1)
+            pool.emplace(options.threads);
+        std::optional<BeamBot> beam;
+        if (options.player == SimPlayer::BEAM)
+            beam.emplace(options.beam, DEFAULT_BOT_WEIGHTS, pool ? &*pool : nullptr);
+        BotStats stats;
+
+        const auto start{std::chrono::steady_clock::now()};
+        for (uint64_t game = 0; game < options.games; game++)
+        {
+            Simulation simulation{options.seed + game, options.randomizer};
+            std::optional<ReplayWriter> writer;
+            if (!options.recordDir.empty())
+                writer.emplace(options.seed + game, options.randomizer);
+
+            ReplayWriter *const replay{writer ? &*writer : nullptr};
+            if (!script.empty())
+            {
+                playScriptedGame(simulation, replay, script, options.maxPieces);
+            }
+            else if (options.player == SimPlayer::GREEDY)
+            {
+                playBotGame(simulation, replay, options.maxPieces, stats, [&](const Simulation &position, std::vector<Action> &path) { greedy.plan(position, path); });
+            }
+            else if (options.player == SimPlayer::BEAM)
+            {
+                playBotGame(simulation, replay, options.maxPieces, stats,
+                            [&](const Simulation &position, std::vector<Action> &path)
+                            {
+                                BeamPlan plan{beam->plan(position)};
+                                path.swap(plan.actions);
+                                stats.beamDepth += plan.depth;
+                                stats.beamWidth += plan.width;
+                            });
+            }
+            else
+            {
+                playRandomGame(simulation, replay, rng, options.maxPieces);
+            }
+
+            if (writer)
+                writer->save(std::filesystem::path(options.recordDir) / ("game-" + std::to_string(game) + ".trpl"), simulation);
+
+            totalPieces += simulation.getPiecesPlaced();
+            totalTicks += simulation.getTickCount();
+        }
+        const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+        std::cout << "games:      " << options.games << '\n'
+                  << "pieces:     " << totalPieces << '\n'
+                  << "ticks:      " << totalTicks << '\n'
+                  << "elapsed:    " << elapsed.count() << " s\n"
+                  << "pieces/sec: " << (elapsed.count() > 0 ? totalPieces / elapsed.count() : 0) << '\n';
+        if (!stats.moveMicros.empty())
+            reportBotStats(options, stats);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "tetris-sim: " << e.what();
+        return 1;
+    }
+    return 0;
+}
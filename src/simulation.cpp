@@ -0,0 +1,240 @@
+#include "simulation.hpp"
+#include "trace.hpp"
+#include <stdexcept>
+#include <utility>
+
+Simulation::Simulation(uint64_t seed, RandomizerMode mode) : gameManager(seed, mode)
+{
+    reset();
+    if (currentTetromino.type == PieceType::NONE)
+    {
+        throw std::runtime_error("Failed to generate initial Tetromino.");
+    }
+}
+
+void Simulation::reset()
+{
+    gameManager.reset(queue);
+    ghostSource.reset();
+    std::optional<Tetromino> next{gameManager.newTetromino(queue.front())};
+    if (next)
+    {
+        currentTetromino = *next;
+        queue.popFront();
+        gameManager.fillQueue(queue);
+    }
+    grounded = false;
+    wasGrounded = false;
+    gravityElapsed = 0;
+    lockDelayElapsed = 0;
+    lockCounter = 0;
+    garbagePending = 0;
+    garbageOutgoing = 0;
+}
+
+uint16_t Simulation::gravityDelayTicks() const
+{
+    const uint8_t delayModifier = std::min(gameManager.getLevel(), 9u);
+    return static_cast<uint16_t>((DELAY - ((DELAY * (delayModifier - 1)) / 15)) * TICK_RATE);
+}
+
+uint16_t Simulation::lockDelayTicks() const
+{
+    const uint8_t delayModifier = std::min(gameManager.getLevel(), 9u);
+    return static_cast<uint16_t>((LOCK_DELAY - ((LOCK_DELAY * (delayModifier - 1)) / 10)) * TICK_RATE);
+}
+
+uint8_t Simulation::tick()
+{
+    TRACE_SCOPE("Simulation::tick");
+    uint8_t events{EVENT_NONE};
+    tickCount++;
+    gravityElapsed++;
+    lockDelayElapsed++;
+
+    wasGrounded = grounded;
+    grounded = gameManager.isGrounded(currentTetromino);
+    if (grounded && lockCounter >= LOCK_LIMIT)
+    {
+        lockPiece(events);
+    }
+    if (gravityElapsed > gravityDelayTicks())
+    {
+        if (!grounded)
+        {
+            currentTetromino.pos.y++;
+            lockDelayElapsed = 0;
+        }
+        else
+        {
+            lockCounter++;
+            if (lockDelayElapsed >= lockDelayTicks())
+            {
+                lockPiece(events);
+            }
+        }
+        gravityElapsed = 0;
+    }
+    return events;
+}
+
+uint8_t Simulation::apply(Action action)
+{
+    uint8_t events{EVENT_NONE};
+    switch (action)
+    {
+    case Action::ROTATE_CCW:
+    case Action::ROTATE_CW:
+    {
+        const Tetromino rotated{action == Action::ROTATE_CW ? currentTetromino.rotatedCW() : currentTetromino.rotatedCCW()};
+        if (gameManager.tryRotate(currentTetromino, rotated))
+        {
+            lockDelayElapsed = 0;
+            if (gameManager.isGrounded(currentTetromino))
+                lockCounter++;
+            events |= EVENT_ROTATED;
+        }
+        break;
+    }
+    case Action::MOVE_LEFT:
+    case Action::MOVE_RIGHT:
+    {
+        const int8_t deltaX = action == Action::MOVE_RIGHT ? 1 : -1;
+        if (gameManager.isValidPosition(currentTetromino, deltaX, 0))
+        {
+            currentTetromino.pos.x += deltaX;
+            if (!wasGrounded && gameManager.isGrounded(currentTetromino))
+            {
+                lockDelayElapsed = 0;
+                lockCounter++;
+            }
+        }
+        break;
+    }
+    case Action::SOFT_DROP:
+    {
+        if (gameManager.isValidPosition(currentTetromino, 0, 1))
+        {
+            currentTetromino.pos.y++;
+            lockDelayElapsed = 0;
+        }
+        else if (lockDelayElapsed >= lockDelayTicks() || lockCounter >= LOCK_LIMIT)
+        {
+            lockPiece(events);
+        }
+        break;
+    }
+    case Action::HARD_DROP:
+    {
+        currentTetromino = getGhostTetromino();
+        lockPiece(events);
+        events |= EVENT_HARD_DROPPED;
+        break;
+    }
+    case Action::RESET:
+    {
+        reset();
+        events |= EVENT_RESET;
+        break;
+    }
+    case Action::HOLD:
+    {
+        if (gameManager.holdTetromino(currentTetromino, queue))
+        {
+            lockDelayElapsed = 0;
+            lockCounter = 0;
+            events |= EVENT_HELD;
+        }
+        else
+        {
+            events |= EVENT_HOLD_FAILED;
+        }
+        break;
+    }
+    }
+    return events;
+}
+
+Tetromino Simulation::getGhostTetromino() const
+{
+    if (ghostSource != currentTetromino)
+    {
+        TRACE_SCOPE("Simulation::ghost");
+        ghostTetromino = currentTetromino;
+        ghostTetromino.pos.y += gameManager.dropDistance(currentTetromino);
+        ghostSource = currentTetromino;
+    }
+    return ghostTetromino;
+}
+
+void Simulation::lockPiece(uint8_t &events)
+{
+    TRACE_SCOPE("Simulation::lockPiece");
+    gameManager.handleCollision(currentTetromino);
+    const bool overflowed{exchangeGarbage(gameManager.clearRows())};
+    ghostSource.reset();
+    if (gameManager.handleWreck(currentTetromino, queue, overflowed))
+        events |= EVENT_TOPPED_OUT;
+    lockDelayElapsed = 0;
+    lockCounter = 0;
+    piecesPlaced++;
+    events |= EVENT_LOCKED;
+}
+
+void Simulation::receiveGarbage(uint8_t lines, uint8_t holeColumn)
+{
+    for (; lines > 0 && garbagePending < garbageHoles.size(); lines--)
+        garbageHoles[garbagePending++] = holeColumn;
+}
+
+uint8_t Simulation::takeOutgoingGarbage()
+{
+    return std::exchange(garbageOutgoing, 0);
+}
+
+// Cancels or sends the attack of a clear, or lets pending lines in when nothing cleared.
+// True when the rising garbage pushed cells off the top of the board.
+bool Simulation::exchangeGarbage(uint8_t rowsCleared)
+{
+    if (rowsCleared > 0)
+    {
+        const uint8_t attack{GARBAGE_ATTACK[rowsCleared]};
+        const uint8_t cancelled{std::min(attack, garbagePending)};
+        std::copy(garbageHoles.begin() + cancelled, garbageHoles.begin() + garbagePending, garbageHoles.begin());
+        garbagePending -= cancelled;
+        garbageOutgoing += attack - cancelled;
+        return false;
+    }
+
+    const uint8_t rising{std::min(garbagePending, GARBAGE_PER_LOCK)};
+    bool overflowed{false};
+    for (uint8_t i = 0; i < rising; i++)
+        overflowed |= gameManager.board.addGarbageRow(garbageHoles[i]);
+    std::copy(garbageHoles.begin() + rising, garbageHoles.begin() + garbagePending, garbageHoles.begin());
+    garbagePending -= rising;
+    return overflowed;
+}
+
+GameState Simulation::snapshot() const
+{
+    return {gameManager, currentTetromino, queue, grounded, wasGrounded, gravityElapsed, lockDelayElapsed, lockCounter,
+            garbageHoles, garbagePending, garbageOutgoing, tickCount, piecesPlaced};
+}
+
+void Simulation::restore(const GameState &state)
+{
+    gameManager = state.gameManager;
+    currentTetromino = state.currentTetromino;
+    queue = state.queue;
+    grounded = state.grounded;
+    wasGrounded = state.wasGrounded;
+    gravityElapsed = state.gravityElapsed;
+    lockDelayElapsed = state.lockDelayElapsed;
+    lockCounter = state.lockCounter;
+    garbageHoles = state.garbageHoles;
+    garbagePending = state.garbagePending;
+    garbageOutgoing = state.garbageOutgoing;
+    tickCount = state.tickCount;
+    piecesPlaced = state.piecesPlaced;
+    ghostSource.reset();
+}
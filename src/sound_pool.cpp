@@ -0,0 +1,116 @@
+#include "sound_pool.hpp"
+#include "trace.hpp"
+
+SoundPool::SoundPool() : audioThread(&SoundPool::audioLoop, this) {}
+
+SoundPool::~SoundPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    audioThread.join();
+}
+
+void SoundPool::play(SoundId id)
+{
+    const size_t next{tail.load(std::memory_order_relaxed)};
+    if (next - head.load(std::memory_order_acquire) == SOUND_QUEUE_CAPACITY)
+        return;
+    queue[next % SOUND_QUEUE_CAPACITY] = id;
+    // Sequentially consistent with the sleeper's flag store, so either it sees
+    // the trigger before sleeping or this sees that it is asleep
+    tail.store(next + 1);
+    if (sleeping.exchange(false))
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+}
+
+bool SoundPool::isPlaying(const Voice &voice) const
+{
+    return voice.sound && voice.sound->getStatus() == sf::SoundSource::Status::Playing;
+}
+
+// A free voice while the effect is under its limit, otherwise the oldest voice
+// of the same effect, and when the whole pool is busy the oldest voice of any
+SoundPool::Voice &SoundPool::pickVoice(SoundId id)
+{
+    Voice *free{};
+    Voice *oldestSame{};
+    Voice *oldest{};
+    uint8_t playing{};
+    for (Voice &voice : voices)
+    {
+        if (!isPlaying(voice))
+        {
+            if (!free)
+                free = &voice;
+            continue;
+        }
+        if (voice.id == id)
+        {
+            playing++;
+            if (!oldestSame || voice.startedAt < oldestSame->startedAt)
+                oldestSame = &voice;
+        }
+        if (!oldest || voice.startedAt < oldest->startedAt)
+            oldest = &voice;
+    }
+    if (playing >= SOUND_SETTINGS[id].maxVoices)
+        return *oldestSame;
+    return free ? *free : *oldest;
+}
+
+void SoundPool::start(SoundId id)
+{
+    TRACE_SCOPE("SoundPool::start");
+    if (!loaded[id].load(std::memory_order_acquire))
+        return;
+
+    Voice &voice{pickVoice(id)};
+    if (!voice.sound)
+        voice.sound.emplace(buffers[id]);
+    else
+    {
+        voice.sound->stop();
+        if (voice.id != id)
+            voice.sound->setBuffer(buffers[id]);
+    }
+    if (voice.id != id)
+        voice.sound->setVolume(SOUND_SETTINGS[id].volume);
+    voice.id = id;
+    voice.startedAt = startCount++;
+    voice.sound->play();
+}
+
+void SoundPool::audioLoop()
+{
+    while (true)
+    {
+        const size_t end{tail.load(std::memory_order_acquire)};
+        for (size_t index = head.load(std::memory_order_relaxed); index != end; index++)
+        {
+            start(queue[index % SOUND_QUEUE_CAPACITY]);
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.store(true);
+        wake.wait(lock, [this]
+                  { return stopping || !sleeping.load() || tail.load() != head.load(std::memory_order_relaxed); });
+        sleeping.store(false);
+        if (stopping)
+            break;
+    }
+
+    for (Voice &voice : voices)
+    {
+        if (voice.sound)
+            voice.sound->stop();
+    }
+}
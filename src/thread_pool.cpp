@@ -0,0 +1,121 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+// Index of the worker running on this thread, or -1 on any other thread
+static thread_local int currentWorker{-1};
+static thread_local const ThreadPool *currentPool{};
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    threadCount = std::max(threadCount, 1u);
+    for (unsigned i = 0; i < threadCount; i++)
+        workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threadCount; i++)
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    const unsigned index{currentPool == this ? static_cast<unsigned>(currentWorker)
+                                             : nextWorker.fetch_add(1, std::memory_order_relaxed) % getThreadCount()};
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+        // Taking the lock orders this notify after any sleeper's predicate check
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    idle.wait(lock, [this]
+              { return pending.load() == 0; });
+    if (firstError)
+    {
+        std::exception_ptr error{firstError};
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()> &task)
+{
+    {
+        Worker &own{*workers[index]};
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned offset = 1; offset < workers.size(); offset++)
+    {
+        Worker &victim{*workers[(index + offset) % workers.size()]};
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index)
+{
+    currentWorker = static_cast<int>(index);
+    currentPool = this;
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (popTask(index, task))
+        {
+            queued.fetch_sub(1);
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!firstError)
+                    firstError = std::current_exception();
+            }
+            task = nullptr;
+
+            if (pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        wake.wait(lock, [this]
+                  { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
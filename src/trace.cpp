@@ -0,0 +1,108 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+static uint32_t currentThreadId()
+{
+    static std::atomic<uint32_t> nextThreadId{1};
+    static thread_local const uint32_t threadId{nextThreadId.fetch_add(1, std::memory_order_relaxed)};
+    return threadId;
+}
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() : origin(std::chrono::steady_clock::now()) {}
+
+uint64_t Tracer::now() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+}
+
+void Tracer::record(const char *name, uint64_t startNs, uint64_t endNs)
+{
+    const uint64_t index{head.fetch_add(1, std::memory_order_relaxed)};
+    Slot &slot{slots[index % TRACE_CAPACITY]};
+
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+    slot.threadId.store(currentThreadId(), std::memory_order_relaxed);
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Tracer::snapshot() const
+{
+    const uint64_t end{head.load(std::memory_order_acquire)};
+    const uint64_t begin{end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0};
+
+    std::vector<TraceEvent> events;
+    events.reserve(end - begin);
+    for (uint64_t index = begin; index < end; index++)
+    {
+        const Slot &slot{slots[index % TRACE_CAPACITY]};
+        const uint64_t before{slot.sequence.load(std::memory_order_acquire)};
+        if (before != index * 2 + 2)
+            continue;
+
+        TraceEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.startNs = slot.startNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        event.threadId = slot.threadId.load(std::memory_order_relaxed);
+
+        // A writer that lapped the ring during the copy leaves a different sequence behind
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+            events.push_back(event);
+    }
+    return events;
+}
+
+void Tracer::writeChromeTrace(const std::filesystem::path &path) const
+{
+    const std::vector<TraceEvent> events{snapshot()};
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path());
+
+    std::ofstream file(path);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceEvent &event{events[i]};
+        // Trace timestamps are microseconds; names are string literals without quotes
+        file << (i ? ",\n" : "\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+             << ",\"ts\":" << event.startNs / 1000 << '.' << event.startNs / 100 % 10
+             << ",\"dur\":" << event.durationNs / 1000 << '.' << event.durationNs / 100 % 10 << '}';
+    }
+    file << "\n]}\n";
+
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write trace " + path.string() + ".\n");
+    }
+}
+
+void FrameTimeStats::add(float milliseconds)
+{
+    samples[next] = milliseconds;
+    next = (next + 1) % CAPACITY;
+    count = std::min(count + 1, CAPACITY);
+}
+
+float FrameTimeStats::percentile(float fraction) const
+{
+    if (count == 0)
+        return 0.0f;
+    std::copy(samples.begin(), samples.begin() + count, scratch.begin());
+    const size_t rank{std::min(count - 1, static_cast<size_t>(std::ceil(fraction * count)) - (fraction > 0.0f ? 1 : 0))};
+    std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.begin() + count);
+    return scratch[rank];
+}
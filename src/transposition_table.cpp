@@ -0,0 +1,86 @@
+#include "transposition_table.hpp"
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint64_t META_MASK{0xFFFF};
+    // Each search of age costs an entry this much depth when picking what to replace
+    constexpr int AGE_WEIGHT{4};
+
+    uint64_t pack(uint64_t key, uint64_t value, uint8_t depth, uint8_t generation)
+    {
+        return ((key ^ value) & ~META_MASK) | uint64_t{depth} << 8 | generation;
+    }
+
+    bool matches(uint64_t check, uint64_t value, uint64_t key)
+    {
+        return ((check ^ value) & ~META_MASK) == (key & ~META_MASK);
+    }
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    size_t bucketCount{1};
+    while (bucketCount * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+        bucketCount *= 2;
+    bucketMask = bucketCount - 1;
+    buckets.reset(new (std::nothrow) Bucket[bucketCount]);
+    if (!buckets)
+    {
+        throw std::runtime_error("Failed to allocate the transposition table.\n");
+    }
+}
+
+std::optional<TableHit> TranspositionTable::probe(uint64_t key) const
+{
+    const Bucket &bucket{buckets[key & bucketMask]};
+    for (const Entry &entry : bucket.entries)
+    {
+        const uint64_t check{entry.check.load(std::memory_order_relaxed)};
+        const uint64_t value{entry.value.load(std::memory_order_relaxed)};
+        if (check != 0 && matches(check, value, key))
+            return TableHit{value, static_cast<uint8_t>(check >> 8)};
+    }
+    return std::nullopt;
+}
+
+void TranspositionTable::store(uint64_t key, uint64_t value, uint8_t depth)
+{
+    const uint8_t now{generation.load(std::memory_order_relaxed)};
+    Bucket &bucket{buckets[key & bucketMask]};
+    Entry *victim{nullptr};
+    int victimWorth{};
+    for (Entry &entry : bucket.entries)
+    {
+        const uint64_t check{entry.check.load(std::memory_order_relaxed)};
+        if (check != 0 && matches(check, entry.value.load(std::memory_order_relaxed), key))
+        {
+            if (depth < static_cast<uint8_t>(check >> 8) && static_cast<uint8_t>(check) == now)
+                return;
+            victim = &entry;
+            break;
+        }
+        const uint8_t age{static_cast<uint8_t>(now - static_cast<uint8_t>(check))};
+        const int worth{check == 0 ? -(1 << 16) : static_cast<int>(static_cast<uint8_t>(check >> 8)) - AGE_WEIGHT * age};
+        if (!victim || worth < victimWorth)
+        {
+            victim = &entry;
+            victimWorth = worth;
+        }
+    }
+    victim->value.store(value, std::memory_order_relaxed);
+    victim->check.store(pack(key, value, depth, now), std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i <= bucketMask; i++)
+    {
+        for (Entry &entry : buckets[i].entries)
+        {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,246 @@
+#include "bot.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct TuneOptions
+    {
+        uint32_t population{64};
+        uint32_t generations{50};
+        uint32_t games{16};
+        uint64_t maxPieces{500};
+        uint64_t seed{1};
+        unsigned threads{std::thread::hardware_concurrency()};
+        RandomizerMode randomizer{RandomizerMode::BAG_7};
+    };
+
+    struct Individual
+    {
+        BotWeights weights{};
+        double fitness{};
+    };
+
+    constexpr uint32_t TOURNAMENT_SIZE{4};
+    constexpr double MUTATION_RATE{0.2};
+    constexpr double MUTATION_STRENGTH{0.2};
+    constexpr double PI{3.14159265358979323846};
+
+    RandomizerMode parseRandomizer(const std::string &name)
+    {
+        if (name == "bag7")
+            return RandomizerMode::BAG_7;
+        if (name == "bag14")
+            return RandomizerMode::BAG_14;
+        if (name == "random")
+            return RandomizerMode::RANDOM;
+        if (name == "history")
+            return RandomizerMode::HISTORY;
+        throw std::runtime_error("Unknown randomizer " + name + ".\n");
+    }
+
+    TuneOptions parseOptions(int argc, char **argv)
+    {
+        TuneOptions options;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg{argv[i]};
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + arg + ".\n");
+            }
+            const std::string value{argv[++i]};
+            if (arg == "--population")
+                options.population = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--generations")
+                options.generations = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--games")
+                options.games = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--pieces")
+                options.maxPieces = std::stoull(value);
+            else if (arg == "--seed")
+                options.seed = std::stoull(value);
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--randomizer")
+                options.randomizer = parseRandomizer(value);
+            else
+                throw std::runtime_error("Unknown option " + arg + ".\n");
+        }
+        if (options.population < 2 || options.games == 0)
+        {
+            throw std::runtime_error("Need a population of at least 2 and at least one game.\n");
+        }
+        return options;
+    }
+
+    double uniform(Xoshiro256 &rng)
+    {
+        return static_cast<double>(rng.next() >> 11) * 0x1.0p-53;
+    }
+
+    // Box-Muller, using 1 - u so the logarithm never sees zero
+    double gaussian(Xoshiro256 &rng)
+    {
+        const double radius{std::sqrt(-2.0 * std::log(1.0 - uniform(rng)))};
+        return radius * std::cos(2.0 * PI * uniform(rng));
+    }
+
+    // Only the direction of the weights changes which placement wins, so keep them unit length
+    BotWeights normalized(BotWeights weights)
+    {
+        float length{};
+        for (float weight : weights)
+            length += weight * weight;
+        length = std::sqrt(length);
+        if (length > 0.0f)
+        {
+            for (float &weight : weights)
+                weight /= length;
+        }
+        return weights;
+    }
+
+    BotWeights randomWeights(Xoshiro256 &rng)
+    {
+        BotWeights weights{};
+        for (float &weight : weights)
+            weight = static_cast<float>(gaussian(rng));
+        return normalized(weights);
+    }
+
+    // Score reached before the game topped out or hit the piece limit
+    uint32_t playGame(const BotWeights &weights, uint64_t seed, const TuneOptions &options)
+    {
+        Simulation simulation{seed, options.randomizer};
+        Bot bot{weights};
+        int score{};
+        for (uint64_t piece = 0; piece < options.maxPieces; piece++)
+        {
+            // Topping out resets the game, so the score has to be read before the piece locks
+            score = simulation.getGameManager().getScore();
+            if (bot.playPiece(simulation) & EVENT_TOPPED_OUT)
+                return static_cast<uint32_t>(score);
+        }
+        return static_cast<uint32_t>(simulation.getGameManager().getScore());
+    }
+
+    // Every individual plays the same seeded games, one pool task per game
+    void evaluate(ThreadPool &pool, std::vector<Individual> &population, uint64_t firstSeed, const TuneOptions &options)
+    {
+        std::vector<uint32_t> scores(population.size() * options.games);
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            for (uint32_t game = 0; game < options.games; game++)
+            {
+                pool.submit([&, i, game]
+                            { scores[i * options.games + game] = playGame(population[i].weights, firstSeed + game, options); });
+            }
+        }
+        pool.wait();
+
+        for (size_t i = 0; i < population.size(); i++)
+        {
+            double total{};
+            for (uint32_t game = 0; game < options.games; game++)
+                total += scores[i * options.games + game];
+            population[i].fitness = total / options.games;
+        }
+    }
+
+    const Individual &tournament(const std::vector<Individual> &population, Xoshiro256 &rng)
+    {
+        const Individual *best{&population[rng.below(static_cast<uint32_t>(population.size()))]};
+        for (uint32_t i = 1; i < TOURNAMENT_SIZE; i++)
+        {
+            const Individual &candidate{population[rng.below(static_cast<uint32_t>(population.size()))]};
+            if (candidate.fitness > best->fitness)
+                best = &candidate;
+        }
+        return *best;
+    }
+
+    // Fitness-weighted blend of two parents, then a small push on one weight
+    BotWeights offspring(const Individual &first, const Individual &second, Xoshiro256 &rng)
+    {
+        const double total{first.fitness + second.fitness};
+        const double share{total > 0 ? first.fitness / total : 0.5};
+
+        BotWeights weights{};
+        for (uint8_t i = 0; i < BOT_FEATURE_COUNT; i++)
+            weights[i] = static_cast<float>(share * first.weights[i] + (1.0 - share) * second.weights[i]);
+        if (uniform(rng) < MUTATION_RATE)
+            weights[rng.below(BOT_FEATURE_COUNT)] += static_cast<float>(gaussian(rng) * MUTATION_STRENGTH);
+        return normalized(weights);
+    }
+
+    std::ostream &printWeights(std::ostream &out, const BotWeights &weights)
+    {
+        out << "{";
+        for (uint8_t i = 0; i < BOT_FEATURE_COUNT; i++)
+            out << (i ? ", " : "") << weights[i] << 'f';
+        return out << "}";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const TuneOptions options{parseOptions(argc, argv)};
+        ThreadPool pool{options.threads};
+        Xoshiro256 rng{options.seed};
+
+        std::vector<Individual> population(options.population);
+        population[0].weights = normalized(DEFAULT_BOT_WEIGHTS);
+        for (size_t i = 1; i < population.size(); i++)
+            population[i].weights = randomWeights(rng);
+        const size_t eliteCount{std::max<size_t>(1, population.size() / 8)};
+
+        std::cout << std::fixed << std::setprecision(4) << "threads: " << pool.getThreadCount() << '\n';
+        Individual best;
+        for (uint32_t generation = 0; generation < options.generations; generation++)
+        {
+            // Fresh games each generation so the weights do not overfit a fixed set of seeds
+            const auto start{std::chrono::steady_clock::now()};
+            evaluate(pool, population, options.seed + uint64_t{generation} * options.games, options);
+            const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+            std::sort(population.begin(), population.end(), [](const Individual &a, const Individual &b)
+                      { return a.fitness > b.fitness; });
+            best = population[0];
+            double meanFitness{};
+            for (const Individual &individual : population)
+                meanFitness += individual.fitness / population.size();
+
+            std::cout << "generation " << generation << "  best " << best.fitness << "  mean " << meanFitness << "  weights ";
+            printWeights(std::cout, best.weights) << "  games/sec "
+                                                  << (elapsed.count() > 0 ? population.size() * options.games / elapsed.count() : 0) << '\n';
+
+            std::vector<Individual> next(population.begin(), population.begin() + eliteCount);
+            while (next.size() < population.size())
+            {
+                const Individual &first{tournament(population, rng)};
+                const Individual &second{tournament(population, rng)};
+                next.push_back({offspring(first, second, rng), 0.0});
+            }
+            population = std::move(next);
+        }
+
+        std::cout << "best weights (aggregate height, holes, bumpiness, lines cleared, row transitions, well depth): ";
+        printWeights(std::cout, best.weights) << '\n';
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "tetris-tune: " << e.what();
+        return 1;
+    }
+    return 0;
+}
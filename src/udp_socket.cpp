@@ -0,0 +1,149 @@
+#include "udp_socket.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+namespace
+{
+    // Winsock has to be started once per process before any socket call
+    struct WinsockSession
+    {
+        WinsockSession()
+        {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            {
+                throw std::runtime_error("Failed to start Winsock.\n");
+            }
+        }
+        ~WinsockSession() { WSACleanup(); }
+    };
+
+    void startWinsock()
+    {
+        static const WinsockSession session;
+    }
+}
+#endif
+
+UdpAddress resolveUdpAddress(const std::string &hostAndPort)
+{
+#ifdef _WIN32
+    startWinsock();
+#endif
+    const size_t colon{hostAndPort.rfind(':')};
+    if (colon == std::string::npos)
+    {
+        throw std::runtime_error("Expected host:port, got " + hostAndPort + ".\n");
+    }
+    const std::string host{hostAndPort.substr(0, colon)};
+    const std::string port{hostAndPort.substr(colon + 1)};
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *found{};
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found)
+    {
+        throw std::runtime_error("Failed to resolve " + hostAndPort + ".\n");
+    }
+    sockaddr_in address{};
+    std::memcpy(&address, found->ai_addr, sizeof(address));
+    freeaddrinfo(found);
+    return {ntohl(address.sin_addr.s_addr), ntohs(address.sin_port)};
+}
+
+UdpSocket::UdpSocket(uint16_t port)
+{
+#ifdef _WIN32
+    startWinsock();
+    handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET)
+#else
+    handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0)
+#endif
+    {
+        throw std::runtime_error("Failed to create a UDP socket.\n");
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+#ifdef _WIN32
+    u_long nonBlocking{1};
+    const bool ready{bind(handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0 &&
+                     ioctlsocket(handle, FIONBIO, &nonBlocking) == 0};
+    if (!ready)
+        closesocket(handle);
+#else
+    const bool ready{bind(handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0 &&
+                     fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK) == 0};
+    if (!ready)
+        close(handle);
+#endif
+    if (!ready)
+    {
+        throw std::runtime_error("Failed to bind UDP port " + std::to_string(port) + ".\n");
+    }
+}
+
+UdpSocket::~UdpSocket()
+{
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    close(handle);
+#endif
+}
+
+// Datagrams are fire and forget; a failed send is just another lost packet
+void UdpSocket::send(const UdpAddress &to, const uint8_t *data, size_t size)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(to.ip);
+    address.sin_port = htons(to.port);
+    sendto(handle, reinterpret_cast<const char *>(data), static_cast<int>(size), 0, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+}
+
+bool UdpSocket::receive(uint8_t *buffer, size_t capacity, size_t &size, UdpAddress &from)
+{
+    sockaddr_in address{};
+    socklen_t addressSize{sizeof(address)};
+    // A datagram bounced back as unreachable fails the call on some systems; skip past it
+    for (int attempt = 0; attempt < 16; attempt++)
+    {
+        const auto received{recvfrom(handle, reinterpret_cast<char *>(buffer), static_cast<int>(capacity), 0, reinterpret_cast<sockaddr *>(&address), &addressSize)};
+        if (received >= 0)
+        {
+            size = static_cast<size_t>(received);
+            from = {ntohl(address.sin_addr.s_addr), ntohs(address.sin_port)};
+            return true;
+        }
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+            return false;
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return false;
+#endif
+    }
+    return false;
+}
@@ -0,0 +1,154 @@
+#include "netplay.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    struct VersusOptions
+    {
+        NetplayOptions netplay;
+        uint32_t ticks{TICK_RATE * 60};
+        uint64_t inputSeed{};
+    };
+
+    VersusOptions parseOptions(int argc, char **argv)
+    {
+        VersusOptions options;
+        options.netplay.seed = 1;
+        bool modeGiven{false};
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg{argv[i]};
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + arg + ".\n");
+            }
+            const std::string value{argv[++i]};
+            if (parseNetplayOption(arg, value, options.netplay))
+                modeGiven |= arg == "--host" || arg == "--join";
+            else if (arg == "--ticks")
+                options.ticks = static_cast<uint32_t>(std::stoul(value));
+            else if (arg == "--seed")
+                options.netplay.seed = std::stoull(value);
+            else if (arg == "--input-seed")
+                options.inputSeed = std::stoull(value);
+            else
+                throw std::runtime_error("Unknown option " + arg + ".\n");
+        }
+        if (!modeGiven)
+        {
+            throw std::runtime_error("Usage: tetris-versus (--host PORT | --join HOST:PORT) [--ticks N] [--seed N] "
+                                     "[--input-seed N] [--latency MS] [--jitter MS] [--loss PERCENT]\n");
+        }
+        return options;
+    }
+
+    // Random held buttons that change every few ticks, standing in for a player
+    class RandomPlayer
+    {
+    public:
+        explicit RandomPlayer(uint64_t seed) : rng(seed) {}
+
+        uint8_t next()
+        {
+            if (ticksLeft == 0)
+            {
+                held = 0;
+                for (uint8_t i = 0; i < ACTION_COUNT; i++)
+                {
+                    if (rng.below(5) == 0)
+                        held |= 1u << i;
+                }
+                ticksLeft = 4 + rng.below(40);
+            }
+            ticksLeft--;
+            return held;
+        }
+
+    private:
+        Xoshiro256 rng;
+        uint8_t held{};
+        uint32_t ticksLeft{};
+    };
+}
+
+// Plays a versus match between two random players over UDP in real time. Run
+// one process with --host and one with --join; both print the checksum of the
+// same final tick, and a desync is reported as soon as the checksums differ.
+int main(int argc, char **argv)
+{
+    try
+    {
+        const VersusOptions options{parseOptions(argc, argv)};
+        Netplay netplay{options.netplay};
+        std::cout << (options.netplay.hosting ? "waiting for a guest on port " + std::to_string(options.netplay.port)
+                                              : "joining " + options.netplay.hostAddress)
+                  << '\n';
+
+        const std::chrono::steady_clock::duration tickTime{std::chrono::nanoseconds(1'000'000'000 / TICK_RATE)};
+        while (!netplay.isStarted())
+        {
+            netplay.poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        RandomPlayer player{options.inputSeed + netplay.getSession().getLocalPlayer()};
+
+        // Keeps ticking past the final tick until it is confirmed, and a little longer so the peer confirms it too
+        std::chrono::steady_clock::time_point nextTick{std::chrono::steady_clock::now()};
+        std::optional<std::chrono::steady_clock::time_point> confirmedAt;
+        uint64_t finalChecksum{};
+        uint64_t ticks{};
+        while (!confirmedAt || std::chrono::steady_clock::now() - *confirmedAt < std::chrono::seconds(1))
+        {
+            netplay.poll();
+            if (netplay.isDisconnected())
+            {
+                throw std::runtime_error("Lost the connection to the peer.\n");
+            }
+            if (netplay.getSession().getTick() < options.ticks)
+            {
+                if (netplay.advance(player.next()))
+                    ticks++;
+            }
+            else
+            {
+                netplay.advance(0);
+            }
+            if (!confirmedAt && netplay.getSession().getLastChecksumTick() >= options.ticks)
+            {
+                confirmedAt = std::chrono::steady_clock::now();
+                finalChecksum = netplay.getSession().getChecksum(options.ticks).value_or(0);
+            }
+
+            nextTick += tickTime;
+            std::this_thread::sleep_until(nextTick);
+        }
+
+        const RollbackSession &session{netplay.getSession()};
+        const RollbackStats &stats{session.getStats()};
+        const Simulation &first{session.getMatch().getPlayer(0)};
+        const Simulation &second{session.getMatch().getPlayer(1)};
+        std::cout << "ticks:            " << ticks << '\n'
+                  << "round trip:       " << netplay.getRoundTripMs() << " ms\n"
+                  << "stalls:           " << netplay.getStalls() << '\n'
+                  << "rollbacks:        " << stats.rollbacks << '\n'
+                  << "mean rollback:    " << (stats.rollbacks > 0 ? static_cast<double>(stats.resimulatedTicks) / stats.rollbacks : 0.0) << " ticks\n"
+                  << "deepest rollback: " << stats.deepestRollback << " ticks\n"
+                  << "pieces:           " << first.getPiecesPlaced() << " / " << second.getPiecesPlaced() << '\n'
+                  << "checksum@" << options.ticks << ":    " << std::hex << finalChecksum << std::dec << '\n';
+        if (netplay.getDesyncTick())
+        {
+            std::cout << "DESYNC at tick " << *netplay.getDesyncTick() << '\n';
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "tetris-versus: " << e.what();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "versus_match.hpp"
+
+// Resetting is a single-player action; a versus board only restarts with the match
+constexpr uint8_t VERSUS_BUTTONS{static_cast<uint8_t>(~(1u << static_cast<uint8_t>(Action::RESET)))};
+
+VersusMatch::VersusMatch(uint64_t seed, const std::array<InputSettings, VERSUS_PLAYERS> &settings)
+    : players{Simulation(seed), Simulation(seed)}, handlers{InputHandler(settings[0]), InputHandler(settings[1])}, garbageRng(~seed)
+{
+}
+
+std::array<uint8_t, VERSUS_PLAYERS> VersusMatch::advance(const std::array<uint8_t, VERSUS_PLAYERS> &held)
+{
+    std::array<uint8_t, VERSUS_PLAYERS> events{};
+    if (result != VersusResult::PLAYING)
+        return events;
+
+    for (uint8_t i = 0; i < VERSUS_PLAYERS; i++)
+    {
+        handlers[i].setHeld(held[i] & VERSUS_BUTTONS, actions);
+        handlers[i].tick(players[i].gravityDelayTicks(), actions);
+        for (Action action : actions)
+            events[i] |= players[i].apply(action);
+        actions.clear();
+        events[i] |= players[i].tick();
+        handlers[i].handleEvents(events[i]);
+    }
+
+    // Both attacks are taken before either is delivered, so player order never matters
+    const std::array<uint8_t, VERSUS_PLAYERS> attacks{players[0].takeOutgoingGarbage(), players[1].takeOutgoingGarbage()};
+    for (uint8_t i = 0; i < VERSUS_PLAYERS; i++)
+    {
+        if (attacks[i] > 0)
+            players[1 - i].receiveGarbage(attacks[i], static_cast<uint8_t>(garbageRng.below(GRID_WIDTH)));
+    }
+
+    const bool firstOut{(events[0] & EVENT_TOPPED_OUT) != 0};
+    const bool secondOut{(events[1] & EVENT_TOPPED_OUT) != 0};
+    if (firstOut && secondOut)
+        result = VersusResult::DRAW;
+    else if (firstOut)
+        result = VersusResult::SECOND_WON;
+    else if (secondOut)
+        result = VersusResult::FIRST_WON;
+    tick++;
+    return events;
+}
+
+VersusState VersusMatch::snapshot() const
+{
+    return {{players[0].snapshot(), players[1].snapshot()}, handlers, garbageRng, tick, result};
+}
+
+void VersusMatch::restore(const VersusState &state)
+{
+    for (uint8_t i = 0; i < VERSUS_PLAYERS; i++)
+        players[i].restore(state.games[i]);
+    handlers = state.handlers;
+    garbageRng = state.garbageRng;
+    tick = state.tick;
+    result = state.result;
+}
+
+// FNV-1a over the fields that decide the outcome; padding bytes are never hashed
+uint64_t versusChecksum(const VersusState &state)
+{
+    uint64_t hash{0xcbf29ce484222325};
+    const auto mix{[&hash](uint64_t value)
+                   {
+                       for (int i = 0; i < 8; i++)
+                       {
+                           hash ^= (value >> (i * 8)) & 0xFF;
+                           hash *= 0x100000001b3;
+                       }
+                   }};
+    for (const GameState &game : state.games)
+    {
+        for (const Board::Row row : game.gameManager.board.rows)
+            mix(row);
+        mix(static_cast<uint64_t>(game.gameManager.getScore()));
+        mix(static_cast<uint64_t>(game.currentTetromino.type) | uint64_t{static_cast<uint8_t>(game.currentTetromino.pos.x)} << 8 |
+            uint64_t{static_cast<uint8_t>(game.currentTetromino.pos.y)} << 16 | uint64_t{static_cast<uint8_t>(game.currentTetromino.rotationIndex)} << 24);
+        mix(game.garbagePending);
+        mix(game.piecesPlaced);
+    }
+    mix(state.tick);
+    mix(static_cast<uint64_t>(state.result));
+    return hash;
+}